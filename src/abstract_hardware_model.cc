@@ -36,6 +36,7 @@
 #include "gpgpu-sim/gpu-sim.h"
 #include "option_parser.h"
 #include <algorithm>
+#include <new>
 #include "cuda-sim/cuda_device_runtime.h"
 
 unsigned mem_access_t::sm_next_access_uid = 0;   
@@ -74,6 +75,14 @@ void gpgpu_functional_sim_config::reg_options(class OptionParser * opp)
 	    &m_ptx_force_max_capability,
 	    "Force maximum compute capability",
 	    "0");
+    option_parser_register(opp, "-gpgpu_ptx_warp_exec", OPT_BOOL,
+	    &m_ptx_warp_exec,
+	    "Execute simple ALU instructions once per warp instead of once per thread",
+	    "0");
+    option_parser_register(opp, "-gpgpu_flat_global_mem", OPT_BOOL,
+	    &m_flat_global_mem,
+	    "Back functional global memory with a single lazily-committed mapping",
+	    "0");
     option_parser_register(opp, "-gpgpu_ptx_inst_debug_to_file", OPT_BOOL, 
 	    &g_ptx_inst_debug_to_file, 
 	    "Dump executed instructions' debug information to file", 
@@ -95,7 +104,7 @@ void gpgpu_functional_sim_config::ptx_set_tex_cache_linesize(unsigned linesize)
 : m_function_model_config(config)
 {
 //    m_global_mem = new memory_space_impl<8192>("global",1024*1024);
-    m_global_mem = new memory_space_impl<8192>("global",64*1024);
+    m_global_mem = new memory_space_impl<8192>("global",64*1024,config.flat_global_mem());
     m_tex_mem = new memory_space_impl<8192>("tex",64*1024);
     m_surf_mem = new memory_space_impl<8192>("surf",64*1024);
 
@@ -104,6 +113,8 @@ void gpgpu_functional_sim_config::ptx_set_tex_cache_linesize(unsigned linesize)
     //Po-Han dynamic child-thread consolidation
     m_child_param_malloc=CHILD_PARAM_START;
 
+    m_checkpoint=NULL;
+
     if(m_function_model_config.get_ptx_inst_debug_to_file() != 0) 
 	ptx_inst_debug_file = fopen(m_function_model_config.get_ptx_inst_debug_file(), "w");
 }
@@ -197,6 +208,7 @@ void warp_inst_t::generate_mem_accesses()
 	return; // predicated off
 
     const size_t starting_queue_size = m_accessq.size();
+    m_accessq.reserve( m_config->warp_size );
 
     assert( is_load() || is_store() );
     assert( m_per_scalar_thread_valid ); // need address information per thread
@@ -417,6 +429,74 @@ void warp_inst_t::generate_mem_accesses()
 	m_mem_accesses_created=true;
 }
 
+// Transactions of one subwarp keyed by block address.  Lookups go through a
+// small open-addressing table and the entries live in fixed inline storage, so
+// coalescing an instruction does not touch the heap.
+class subwarp_transaction_table {
+public:
+    typedef warp_inst_t::transaction_info transaction_info;
+
+    subwarp_transaction_table() : m_n(0)
+    {
+	for( unsigned s=0; s < HASH_SIZE; s++ )
+	    m_slot[s] = EMPTY_SLOT;
+    }
+
+    transaction_info &operator[]( unsigned block_address )
+    {
+	unsigned s = (block_address * 2654435761u) >> (32 - HASH_BITS);
+	while( m_slot[s] != EMPTY_SLOT ) {
+	    if( m_key[m_slot[s]] == block_address )
+		return info(m_slot[s]);
+	    s = (s + 1) & (HASH_SIZE - 1);
+	}
+	assert( m_n < MAX_TRANSACTIONS );
+	m_slot[s] = m_n;
+	m_key[m_n] = block_address;
+	m_hash_pos[m_n] = s;
+	return *new (&m_storage[m_n++ * ENTRY_WORDS]) transaction_info();
+    }
+
+    unsigned size() const { return m_n; }
+
+    // order the entries by ascending block address, as std::map iteration
+    // did; addresses of a subwarp are usually already ascending, which makes
+    // the insertion sort linear
+    void sort( unsigned *order ) const
+    {
+	for( unsigned i=0; i < m_n; i++ ) {
+	    unsigned j = i;
+	    for( ; j > 0 && m_key[order[j-1]] > m_key[i]; j-- )
+		order[j] = order[j-1];
+	    order[j] = i;
+	}
+    }
+    unsigned key( unsigned i ) const { return m_key[i]; }
+    transaction_info &info( unsigned i ) { return *(transaction_info*)&m_storage[i * ENTRY_WORDS]; }
+
+    void clear()
+    {
+	for( unsigned i=0; i < m_n; i++ )
+	    m_slot[m_hash_pos[i]] = EMPTY_SLOT;
+	m_n = 0;
+    }
+
+    static const unsigned MAX_TRANSACTIONS = MAX_WARP_SIZE * MAX_ACCESSES_PER_INSN_PER_THREAD;
+
+private:
+    static const unsigned HASH_BITS = 9; // 2x MAX_TRANSACTIONS slots
+    static const unsigned HASH_SIZE = 1 << HASH_BITS;
+    static const unsigned short EMPTY_SLOT = 0xffff;
+    static const unsigned ENTRY_WORDS = (sizeof(transaction_info) + sizeof(unsigned long long) - 1) / sizeof(unsigned long long);
+
+    unsigned m_n;
+    unsigned short m_slot[HASH_SIZE];
+    unsigned short m_hash_pos[MAX_TRANSACTIONS];
+    unsigned m_key[MAX_TRANSACTIONS];
+    // raw storage so that unused entries are never constructed
+    unsigned long long m_storage[MAX_TRANSACTIONS * ENTRY_WORDS];
+};
+
 void warp_inst_t::memory_coalescing_arch_13( bool is_write, mem_access_type access_type )
 {
     // see the CUDA manual where it discusses coalescing rules before reading this
@@ -430,9 +510,11 @@ void warp_inst_t::memory_coalescing_arch_13( bool is_write, mem_access_type acce
     unsigned subwarp_size = m_config->warp_size / warp_parts;
 
     bool global_constant_sharing_bypass;
+    subwarp_transaction_table subwarp_transactions;
+    unsigned order[subwarp_transaction_table::MAX_TRANSACTIONS];
 
     for( unsigned subwarp=0; subwarp <  warp_parts; subwarp++ ) {
-	std::map<new_addr_type,transaction_info> subwarp_transactions;
+	subwarp_transactions.clear();
 
 	// step 1: find all transactions generated by this subwarp
 	for( unsigned thread=subwarp*subwarp_size; thread<subwarp_size*(subwarp+1); thread++ ) {
@@ -487,10 +569,10 @@ void warp_inst_t::memory_coalescing_arch_13( bool is_write, mem_access_type acce
 	}
 
 	// step 2: reduce each transaction size, if possible
-	std::map< new_addr_type, transaction_info >::iterator t;
-	for( t=subwarp_transactions.begin(); t !=subwarp_transactions.end(); t++ ) {
-	    new_addr_type addr = t->first;
-	    const transaction_info &info = t->second;
+	subwarp_transactions.sort(order);
+	for( unsigned t=0; t < subwarp_transactions.size(); t++ ) {
+	    new_addr_type addr = subwarp_transactions.key(order[t]);
+	    const transaction_info &info = subwarp_transactions.info(order[t]);
 
 	    memory_coalescing_arch_13_reduce_and_send(is_write, access_type, info, addr, segment_size);
 
@@ -634,9 +716,6 @@ bool warp_inst_t::check_global_constant_sharing_bypass( new_addr_type addr, unsi
 //    extern bool g_child_param_buffer_compaction;
     extern int g_global_constant_pointer_sharing;
 //    extern int g_child_parameter_buffer_alignment;
-    extern application_id g_app_name;
-//    extern int global_constant_offset[12][6];
-    extern unsigned global_constant_pc[12][12];
     if(addr >= CHILD_PARAM_START && addr < CHILD_PARAM_END){
 	if(g_global_constant_pointer_sharing > 0){
 	    if(g_global_constant_pointer_sharing == 2){ // always bypass
@@ -644,19 +723,8 @@ bool warp_inst_t::check_global_constant_sharing_bypass( new_addr_type addr, unsi
 		return true;
 	    } else if (g_global_constant_pointer_sharing == 1){ 
 //		if(g_child_param_buffer_compaction){
-		    //check PC
-		if(g_app_name == 1 || g_app_name == 7 || g_app_name == 8 ){
-		    if ( (pc >= global_constant_pc[g_app_name][0] && pc <= global_constant_pc[g_app_name][1]) ||
-			 (pc >= global_constant_pc[g_app_name][2] && pc <= global_constant_pc[g_app_name][3]) )
-			return true;
-		} else {
-		    for( int i = 0; i < 12; i++ ){
-			if( global_constant_pc[g_app_name][i] == pc ){
-			    //			    printf("CPB: pc 0x%04X app_name %d gc_num %d\n", pc, g_app_name, i);
-			    return true;
-			}
-		    }
-		}
+		    //check PC against the const loads of the kernel's parameter layout
+		return dcc_is_global_constant_pc(pc);
 		//		} else {
 		    // check address
 //		    unsigned int offset = addr % g_child_parameter_buffer_alignment;
@@ -709,6 +777,8 @@ kernel_info_t::kernel_info_t( dim3 gridDim, dim3 blockDim, class function_info *
 
     //Jin: launch latency management
     m_launch_latency = g_kernel_launch_latency;
+    m_sampled = false;
+    m_fast_forward = false;
 
     //Po-Han: DCC
     is_child = false;
@@ -853,6 +923,39 @@ kernel_info_t::~kernel_info_t()
     delete[] block_state;
 }
 
+void kernel_info_t::set_param_segment( unsigned int seg_end, class memory_space *mem, addr_t base )
+{
+    m_param_mem_map[seg_end] = mem;
+    m_param_mem_base_map[seg_end] = base;
+
+    // merged segments come after the existing ones, so this is normally an append
+    if( m_param_seg_end.empty() || seg_end > m_param_seg_end.back() ){
+	m_param_seg_end.push_back(seg_end);
+	m_param_seg_mem.push_back(mem);
+	m_param_seg_base.push_back(base);
+    } else {
+	unsigned pos = std::lower_bound(m_param_seg_end.begin(), m_param_seg_end.end(), seg_end) - m_param_seg_end.begin();
+	if( m_param_seg_end[pos] == seg_end ){
+	    m_param_seg_mem[pos] = mem;
+	    m_param_seg_base[pos] = base;
+	} else {
+	    m_param_seg_end.insert(m_param_seg_end.begin() + pos, seg_end);
+	    m_param_seg_mem.insert(m_param_seg_mem.begin() + pos, mem);
+	    m_param_seg_base.insert(m_param_seg_base.begin() + pos, base);
+	}
+    }
+    assert( m_param_seg_end.size() == m_param_mem_map.size() && m_param_seg_end.size() == m_param_mem_base_map.size() );
+}
+
+void kernel_info_t::clear_param_segments()
+{
+    m_param_mem_map.clear();
+    m_param_mem_base_map.clear();
+    m_param_seg_end.clear();
+    m_param_seg_mem.clear();
+    m_param_seg_base.clear();
+}
+
 std::string kernel_info_t::name() const
 {
     return m_kernel_entry->get_name();
@@ -919,11 +1022,12 @@ void kernel_info_t::notify_parent_finished() {
 		name().find("find1_CdpKernel") != std::string::npos ||
 		name().find("find2_CdpKernel") != std::string::npos ||
 		name().find("relabelUnrollKernel") != std::string::npos ){
-	    if(g_agg_blocks_support || g_dyn_child_thread_consolidation){ //DTBL or DKC
+	    if(g_agg_blocks_support || g_dyn_child_thread_consolidation || g_cdp_warp_launch_batching){ //DTBL, DKC or batched CDP
 		char mech[5], sche[5];
 		extern bool g_child_aware_smk_scheduling;
 		if(g_dyn_child_thread_consolidation) sprintf(mech, "DKC");
-		else sprintf(mech, "DTBL");
+		else if(g_agg_blocks_support) sprintf(mech, "DTBL");
+		else sprintf(mech, "CDP");
 		if(g_child_aware_smk_scheduling) sprintf(sche, "-DPS");
 		else sprintf(sche, "");
 
@@ -1123,12 +1227,17 @@ void kernel_info_t::add_agg_block_group(agg_block_group_t * agg_block_group) {
 
     m_total_num_agg_blocks += agg_block_group->get_num_blocks();
 
-    assert(m_agg_block_groups.find(m_total_agg_group_id) ==
-	    m_agg_block_groups.end());
-    m_agg_block_groups[m_total_agg_group_id] = agg_block_group;
+    //each lane of a warp launch batch takes its own agg_group_id
+    agg_block_group->set_first_agg_group_id(m_total_agg_group_id);
+    for(unsigned lane = 0; lane < agg_block_group->get_num_lanes(); lane++) {
+	assert(m_agg_block_groups.find(m_total_agg_group_id) ==
+		m_agg_block_groups.end());
+	m_agg_block_groups[m_total_agg_group_id] = agg_block_group;
 
-    printf("DTBL: kernel %u add agg group, totally %d\n", m_uid, m_total_agg_group_id);
-    m_total_agg_group_id++;
+	if(!agg_block_group->is_warp_batch())
+	    printf("DTBL: kernel %u add agg group, totally %d\n", m_uid, m_total_agg_group_id);
+	m_total_agg_group_id++;
+    }
 
     delete[] block_state;
     block_state = new block_info[num_blocks()];
@@ -1149,7 +1258,8 @@ void kernel_info_t::add_agg_block_group(agg_block_group_t * agg_block_group) {
 
     assert(unissued_agg_groups);
     unissued_agg_groups--;
-    m_parent_threads.push_back(agg_block_group->get_parent_thd()); //record parent thread for parent-child dependency support
+    for(unsigned lane = 0; lane < agg_block_group->get_num_lanes(); lane++)
+	m_parent_threads.push_back(agg_block_group->get_parent_thd(lane)); //record parent thread for parent-child dependency support
 }
 
 void kernel_info_t::destroy_agg_block_groups() {
@@ -1160,7 +1270,9 @@ void kernel_info_t::destroy_agg_block_groups() {
 #if 1
 	extern bool *g_kernel_queue_entry_empty;
 	extern unsigned int g_kernel_queue_entry_used;//, g_kernel_queue_entry_running; 
-	if( agg_block_group->second->get_kernel_queue_entry_id() == -1 ){
+	if( agg_block_group->second->is_warp_batch() ){
+	    //batched CDP launches are not charged any kernel metadata
+	} else if( agg_block_group->second->get_kernel_queue_entry_id() == -1 ){
 	    extern unsigned long long total_num_offchip_metadata;
 	    if(total_num_offchip_metadata > 0) total_num_offchip_metadata--;
 	} else {
@@ -1185,42 +1297,55 @@ void kernel_info_t::destroy_agg_block_groups() {
 	g_total_param_size -= ((param_buf_size + g_child_parameter_buffer_alignment - 1)/ g_child_parameter_buffer_alignment * g_child_parameter_buffer_alignment);
 	if(g_total_param_size < 0) g_total_param_size = 0;
 
-	delete agg_block_group->second;
+	//a warp launch batch is mapped once per lane, delete it with its last lane
+	if(agg_block_group->first == agg_block_group->second->get_first_agg_group_id() + (int)agg_block_group->second->get_num_lanes() - 1)
+	    delete agg_block_group->second;
     }
 
     m_agg_block_groups.clear();
 }
 
+agg_block_group_t * kernel_info_t::find_agg_block_group(int agg_group_id, unsigned &lane) const {
+    std::map<int, agg_block_group_t *>::const_iterator it = m_agg_block_groups.find(agg_group_id);
+    assert(it != m_agg_block_groups.end());
+    lane = agg_group_id - it->second->get_first_agg_group_id();
+    return it->second;
+}
+
 dim3 kernel_info_t::get_agg_dim(int agg_group_id) const {
-    assert(m_agg_block_groups.find(agg_group_id) !=
-	    m_agg_block_groups.end());
-    return m_agg_block_groups.find(agg_group_id)->second->get_agg_dim();
+    unsigned lane;
+    return find_agg_block_group(agg_group_id, lane)->get_agg_dim(lane);
 }
 
 class memory_space * kernel_info_t::get_agg_param_mem(int agg_group_id) {
-    assert(m_agg_block_groups.find(agg_group_id) !=
-	    m_agg_block_groups.end());
-    return m_agg_block_groups.find(agg_group_id)->second->get_param_memory();
+    unsigned lane;
+    return find_agg_block_group(agg_group_id, lane)->get_param_memory(lane);
 }
 
 addr_t kernel_info_t::get_agg_param_mem_base(int agg_group_id) {
-    assert(m_agg_block_groups.find(agg_group_id) !=
-	    m_agg_block_groups.end());
-    return m_agg_block_groups.find(agg_group_id)->second->get_param_memory_base();
+    unsigned lane;
+    return find_agg_block_group(agg_group_id, lane)->get_param_memory_base(lane);
 }
 
 void kernel_info_t::increment_cta_id() 
 { 
     dim3 next_grid_dim = get_grid_dim(m_next_agg_group_id);
     if(increment_x_then_y_then_z(m_next_cta, next_grid_dim)) { //overbound
+	//the lanes of a warp launch batch share one launch record, account for it on the first lane only
+	unsigned lane = 0;
+	if(m_next_agg_group_id != -1)
+	    find_agg_block_group(m_next_agg_group_id, lane);
+	bool first_lane = (lane == 0);
+
 	m_next_agg_group_id++;
 	m_next_cta.x = 0;
 	m_next_cta.y = 0;
 	m_next_cta.z = 0;
-	printf("DTBL: kernel %u overbound. next agg group %d total agg group %d\n", m_uid, m_next_agg_group_id, m_total_agg_group_id);
+	if( first_lane )
+	    printf("DTBL: kernel %u overbound. next agg group %d total agg group %d\n", m_uid, m_next_agg_group_id, m_total_agg_group_id);
 
 	extern bool g_dcc_kernel_param_onchip;
-	if( g_dcc_kernel_param_onchip && is_child ){
+	if( g_dcc_kernel_param_onchip && is_child && first_lane ){
 	    extern signed kernel_param_usage;
 	    extern signed long long param_buffer_usage;
 	    extern unsigned g_max_param_buffer_size;
@@ -1269,6 +1394,12 @@ int kernel_info_t::get_kernel_queue_entry(int agg_group_id)
     return m_agg_block_groups.find(agg_group_id)->second->get_kernel_queue_entry_id();
 }
 
+bool kernel_info_t::is_warp_batch_agg_group(int agg_group_id)
+{
+    unsigned lane;
+    return find_agg_block_group(agg_group_id, lane)->is_warp_batch();
+}
+
 simt_stack::simt_stack( unsigned wid, unsigned warpSize)
 {
     m_warp_id=wid;
@@ -1477,6 +1608,8 @@ void simt_stack::update( simt_mask_t &thread_done, addr_vector_t &next_pc, addre
 
 void core_t::execute_warp_inst_t(warp_inst_t &inst, unsigned warpId)
 {
+    if( m_gpu->get_config().ptx_warp_exec() && ptx_warp_exec_inst(this,inst,warpId) )
+	return;
     for ( unsigned t=0; t < m_warp_size; t++ ) {
 	if( inst.active(t) ) {
 	    if(warpId==(unsigned (-1)))
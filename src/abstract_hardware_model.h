@@ -244,6 +244,20 @@ class switched_out_cta{
 		warp_set_t m_warp_at_barrier; //static
 };
 
+//Per-SM occupancy of a kernel for one CTA size, cached on its function_info by
+//shader_core_config::occupancy(). It is recomputed when the configuration epoch changes,
+//e.g. after a cache-config change resizes the shared memory.
+struct kernel_occupancy_t {
+	kernel_occupancy_t() : config_epoch((unsigned)-1) {}
+	unsigned config_epoch;
+	unsigned padded_cta_size;
+	unsigned smem_per_cta;
+	unsigned regs_per_cta;
+	//CTAs per SM allowed by thread slots, shared memory, registers and the CTA limit
+	unsigned cta_by_threads, cta_by_shmem, cta_by_regs, cta_by_limit;
+	unsigned max_cta;
+};
+
 class kernel_info_t {
 	public:
 		//   kernel_info_t()
@@ -443,6 +457,14 @@ class kernel_info_t {
 		std::map<unsigned int, class memory_space *> m_param_mem_map;
 		std::map<unsigned int, addr_t> m_param_mem_base_map;
 		std::map<unsigned int, int> m_kernel_queue_entry_map;
+		// flat copy of the keys and values of the two maps above, ordered by
+		// segment end thread id so that set_param_mem() can binary-search it;
+		// the maps are only changed through set/clear_param_segment(s) to keep it in sync
+		std::vector<unsigned int> m_param_seg_end;
+		std::vector<class memory_space *> m_param_seg_mem;
+		std::vector<addr_t> m_param_seg_base;
+		void set_param_segment( unsigned int seg_end, class memory_space *mem, addr_t base );
+		void clear_param_segments();
 		bool is_child;
 		signed int param_entry_cnt;
 		unsigned **per_SM_block_cnt;
@@ -462,6 +484,7 @@ class kernel_info_t {
 		std::list<unsigned int> switching_list;
 		std::list<unsigned int> preempted_list;
 		int get_kernel_queue_entry(int agg_group_id);
+		bool is_warp_batch_agg_group(int agg_group_id);
 
 		bool no_more_block_to_run()
 		{
@@ -533,6 +556,7 @@ class kernel_info_t {
 		addr_t get_agg_param_mem_base(int agg_group_id);
 		int get_next_agg_group_id() { return m_next_agg_group_id; }
 	private:
+		agg_block_group_t * find_agg_block_group(int agg_group_id, unsigned &lane) const;
 		int m_next_agg_group_id;
 		int m_total_agg_group_id;
 		std::map<int, agg_block_group_t *> m_agg_block_groups; //aggregated block groups
@@ -543,6 +567,10 @@ class kernel_info_t {
 		unsigned long long start_cycle;
 		unsigned long long end_cycle;
 		unsigned m_launch_latency;
+
+		// sampled simulation mode of a host kernel (see gpgpu-sim/sampler.h)
+		bool m_sampled;
+		bool m_fast_forward;
 };
 
 struct core_config {
@@ -554,6 +582,7 @@ struct core_config {
 		gpgpu_shmem_sizeDefault=(unsigned)-1;
 		gpgpu_shmem_sizePrefL1=(unsigned)-1;
 		gpgpu_shmem_sizePrefShared=(unsigned)-1;
+		gpgpu_occupancy_epoch=0;
 	}
 	virtual void init() = 0;
 
@@ -576,6 +605,7 @@ struct core_config {
 	unsigned gpgpu_shmem_sizeDefault;
 	unsigned gpgpu_shmem_sizePrefL1;
 	unsigned gpgpu_shmem_sizePrefShared;
+	mutable unsigned gpgpu_occupancy_epoch; // bumped whenever per-SM resources change; invalidates kernel_occupancy_t
 
 	// texture and constant cache line sizes (used to determine number of memory accesses)
 	unsigned gpgpu_cache_texl1_linesize;
@@ -729,6 +759,8 @@ class gpgpu_functional_sim_config
 		const char* get_ptx_inst_debug_file() const  { return g_ptx_inst_debug_file; }
 		int         get_ptx_inst_debug_thread_uid() const { return g_ptx_inst_debug_thread_uid; }
 		unsigned    get_texcache_linesize() const { return m_texcache_linesize; }
+		bool        ptx_warp_exec() const { return m_ptx_warp_exec; }
+		bool        flat_global_mem() const { return m_flat_global_mem; }
 
 	private:
 		// PTX options
@@ -736,6 +768,8 @@ class gpgpu_functional_sim_config
 		int m_ptx_use_cuobjdump;
 		int m_experimental_lib_support;
 		unsigned m_ptx_force_max_capability;
+		int m_ptx_warp_exec;
+		int m_flat_global_mem;
 
 		int   g_ptx_inst_debug_to_file;
 		char* g_ptx_inst_debug_file;
@@ -758,6 +792,8 @@ class gpgpu_t {
 		class memory_space *get_global_memory() { return m_global_mem; }
 		class memory_space *get_tex_memory() { return m_tex_mem; }
 		class memory_space *get_surf_memory() { return m_surf_mem; }
+		class sim_checkpoint *get_checkpoint() { return m_checkpoint; }
+		unsigned long long child_param_top() const { return m_child_param_malloc; }
 
 		void gpgpu_ptx_sim_bindTextureToArray(const struct textureReference* texref, const struct cudaArray* array);
 		void gpgpu_ptx_sim_bindNameToTexture(const char* name, const struct textureReference* texref, int dim, int readmode, int ext);
@@ -807,6 +843,8 @@ class gpgpu_t {
 		//Po-Han: dynamic child kernel consolidation
 		unsigned long long m_child_param_malloc;
 
+		class sim_checkpoint *m_checkpoint; // NULL unless checkpointing is enabled
+
 		std::map<std::string, const struct textureReference*> m_NameToTextureRef;
 		std::map<const struct textureReference*,const struct cudaArray*> m_TextureRefToCudaArray;
 		std::map<const struct textureReference*, const struct textureInfo*> m_TextureRefToTexureInfo;
@@ -1302,7 +1340,7 @@ class warp_inst_t: public inst_t {
 		bool m_per_scalar_thread_valid;
 		std::vector<per_thread_info> m_per_scalar_thread;
 		bool m_mem_accesses_created;
-		std::list<mem_access_t> m_accessq;
+		std::vector<mem_access_t> m_accessq; // consumed from the back
 
 		static unsigned sm_next_uid;
 
@@ -1,61 +1,156 @@
 #pragma once
 
+#include <vector>
 #include "cuda-sim/memory.h"
 #include "cuda-sim/ptx_sim.h"
 
+//One lane's slice of a parameter table shared by several launches
+class param_table_slice_t : public memory_space {
+public:
+    param_table_slice_t(memory_space * table, mem_addr_t offset) : m_table(table), m_offset(offset) {}
+
+    virtual void write( mem_addr_t addr, size_t length, const void *data, ptx_thread_info *thd, const ptx_instruction *pI ) {
+        m_table->write(m_offset + addr, length, data, thd, pI);
+    }
+    virtual void read( mem_addr_t addr, size_t length, void *data ) const {
+        m_table->read(m_offset + addr, length, data);
+    }
+    virtual void print( const char *format, FILE *fout ) const { m_table->print(format, fout); }
+    virtual void set_watch( addr_t addr, unsigned watchpoint ) { m_table->set_watch(m_offset + addr, watchpoint); }
+    virtual void save( FILE *fp ) const { m_table->save(fp); }
+    virtual bool load( FILE *fp ) { return m_table->load(fp); }
+    virtual void set_observer( mem_touch_observer *observer ) { m_table->set_observer(observer); }
+
+private:
+    memory_space * m_table;
+    mem_addr_t m_offset;
+};
+
 //Class definition for aggregated block group
+//A DTBL group holds one launch. A warp launch batch (-cdp_warp_launch_batching)
+//holds the launches of several lanes of one warp, one table entry per lane, with
+//their parameters packed into a single parameter table. Each lane takes one
+//agg_group_id of the native kernel.
 class agg_block_group_t {
 public:
 
     agg_block_group_t(dim3 agg_dim, 
         dim3 block_dim, kernel_info_t * kernel, addr_t p_mem_base, int kernelq_entry_id, ptx_thread_info *thread ) {
-        m_agg_block_group_dim = agg_dim;
         m_agg_block_dim = block_dim;
         m_kernel = kernel;
         m_param_mem = new memory_space_impl<256>("param", 256);
-	m_param_mem_base = p_mem_base; //bddream - DKPL
+	m_lane_param_size = 0;
+	m_warp_batch = false;
+	m_first_agg_group_id = -1;
 	kernel_queue_entry_id = kernelq_entry_id;
-	p_thd = thread;
+	m_lanes.reserve(1);
+	add_lane(agg_dim, p_mem_base, thread);
     }
-    dim3 get_agg_dim() const {
-        return m_agg_block_group_dim;
+
+    //warp launch batch for up to max_lanes lanes, lane_param_size bytes of parameters each
+    agg_block_group_t(dim3 block_dim, kernel_info_t * kernel, unsigned max_lanes, unsigned lane_param_size) {
+        m_agg_block_dim = block_dim;
+        m_kernel = kernel;
+        m_param_mem = new memory_space_impl<256>("param", 256);
+	m_lane_param_size = lane_param_size;
+	m_warp_batch = true;
+	m_first_agg_group_id = -1;
+	kernel_queue_entry_id = -1; //CDP launches hold no kernel queue entry
+	m_lanes.reserve(max_lanes);
+    }
+
+    ~agg_block_group_t() {
+        delete m_param_mem;
+    }
+
+    //append a launch, returns its slice of the parameter table
+    class memory_space * add_lane(dim3 agg_dim, addr_t p_mem_base, ptx_thread_info *thread) {
+        assert(m_lanes.size() < m_lanes.capacity()); //slices must not move
+        m_lanes.push_back(lane_t(agg_dim, p_mem_base, thread, 
+                    param_table_slice_t(m_param_mem, m_lanes.size() * m_lane_param_size)));
+        return &m_lanes.back().param_mem;
+    }
+
+    unsigned get_num_lanes() const {
+        return m_lanes.size();
+    }
+
+    bool is_warp_batch() const {
+        return m_warp_batch;
+    }
+
+    kernel_info_t * get_kernel() const {
+        return m_kernel;
+    }
+
+    //agg_group_id of lane 0, set when the group is added to its kernel
+    void set_first_agg_group_id(int agg_group_id) {
+        m_first_agg_group_id = agg_group_id;
+    }
+
+    int get_first_agg_group_id() const {
+        return m_first_agg_group_id;
+    }
+
+    dim3 get_agg_dim(unsigned lane = 0) const {
+        return m_lanes[lane].agg_dim;
     }
 
     dim3 get_block_dim() const {
         return m_agg_block_dim;
     }
 
+    size_t get_num_blocks(unsigned lane) const {
+        return m_lanes[lane].agg_dim.x *
+            m_lanes[lane].agg_dim.y *
+            m_lanes[lane].agg_dim.z;
+    }
+
     size_t get_num_blocks() const {
-        return m_agg_block_group_dim.x *
-            m_agg_block_group_dim.y *
-            m_agg_block_group_dim.z;
+        size_t num_blocks = 0;
+        for(unsigned lane = 0; lane < m_lanes.size(); lane++)
+            num_blocks += get_num_blocks(lane);
+        return num_blocks;
     }
 
-    class memory_space * get_param_memory() const {
-        return m_param_mem;
+    class memory_space * get_param_memory(unsigned lane = 0) {
+        return &m_lanes[lane].param_mem;
     }
 
     // bddream - DKPL
-    addr_t get_param_memory_base() const {
-       return m_param_mem_base;
+    addr_t get_param_memory_base(unsigned lane = 0) const {
+       return m_lanes[lane].param_mem_base;
     }
 
     int get_kernel_queue_entry_id() const {
 	return kernel_queue_entry_id;
     }
 
-    ptx_thread_info * get_parent_thd() const {
-	return p_thd;
+    ptx_thread_info * get_parent_thd(unsigned lane = 0) const {
+	return m_lanes[lane].p_thd;
     }
 
 private:
-    dim3 m_agg_block_group_dim; // aggregated block group dim, similar to kernel grid dim
+    agg_block_group_t( const agg_block_group_t &another ); // not copyable: owns its parameter table
+
+    struct lane_t {
+        lane_t(dim3 dim, addr_t p_mem_base, ptx_thread_info *thread, const param_table_slice_t &slice) :
+            agg_dim(dim), param_mem_base(p_mem_base), p_thd(thread), param_mem(slice) {}
+
+        dim3 agg_dim; // aggregated block group dim, similar to kernel grid dim
+        addr_t param_mem_base; // bddream - DKPL
+        ptx_thread_info *p_thd; // pointer to parent thread; for parent-child dependency
+        param_table_slice_t param_mem; // this launch's parameters
+    };
+
     dim3 m_agg_block_dim; // aggregated block dim
     kernel_info_t * m_kernel; // the native kernel to be aggregated to
-    class memory_space * m_param_mem; // parameter buffer
+    class memory_space * m_param_mem; // parameter buffer, one slice per lane
+    unsigned m_lane_param_size;
+    bool m_warp_batch;
+    int m_first_agg_group_id;
+    std::vector<lane_t> m_lanes;
 
-    addr_t m_param_mem_base; // bddream - DKPL
     int kernel_queue_entry_id;
-    ptx_thread_info *p_thd; // pointer to parent thread; for parent-child dependency
 
 };
@@ -44,6 +44,8 @@
 #include "ptx_loader.h"
 #include "ptx_parser.h"
 #include "../gpgpu-sim/gpu-sim.h"
+#include "../gpgpu-sim/checkpoint.h"
+#include "../gpgpu-sim/sampler.h"
 #include "ptx_sim.h"
 #include "../gpgpusim_entrypoint.h"
 #include "decuda_pred_table/decuda_pred_table.h"
@@ -236,6 +238,11 @@ void function_info::ptx_assemble()
 		}
 	}
 	g_assemble_code_next_pc=PC;
+
+	// number registers densely so a call frame can hold them in a flat array
+	for( unsigned r=0; r < m_reg_decls.size(); r++ ) 
+		m_reg_decls[r]->set_reg_slot(this,r);
+
 	for ( unsigned ii=0; ii < n; ii += m_instr_mem[ii]->inst_size() ) { // handle branch instructions
 		ptx_instruction *pI = m_instr_mem[ii];
 		if ( pI->get_opcode() == BRA_OP || pI->get_opcode() == BREAKADDR_OP  || pI->get_opcode() == CALLP_OP) {
@@ -431,8 +438,12 @@ void gpgpu_t::memcpy_from_gpu( void *dst, size_t src_start_addr, size_t count )
 		fflush(stdout);
 	}
 	unsigned char *dst_data = (unsigned char*)dst;
-	for (unsigned n=0; n < count; n ++ ) 
-		m_global_mem->read(src_start_addr+n,1,dst_data+n);
+	if( m_checkpoint == NULL || !m_checkpoint->replay_host_read(dst,count) ) {
+		for (unsigned n=0; n < count; n ++ ) 
+			m_global_mem->read(src_start_addr+n,1,dst_data+n);
+	}
+	if( m_checkpoint ) 
+		m_checkpoint->record_host_read(dst,count);
 	if(g_debug_execution >= 3) {
 		printf( " done.\n");
 		fflush(stdout);
@@ -882,8 +893,11 @@ void ptx_instruction::pre_decode()
 
 	bool has_dst = false ;
 
+	// resolve the semantic routine once so execution does not go through the opcode switch
+	m_exec_fn = NULL;
+	m_op_classification = 0;
 	switch ( get_opcode() ) {
-#define OP_DEF(OP,FUNC,STR,DST,CLASSIFICATION) case OP: has_dst = (DST!=0); break;
+#define OP_DEF(OP,FUNC,STR,DST,CLASSIFICATION) case OP: has_dst = (DST!=0); m_exec_fn = FUNC; m_op_classification = CLASSIFICATION; break;
 #include "opcodes.def"
 #undef OP_DEF
 		default:
@@ -891,6 +905,14 @@ void ptx_instruction::pre_decode()
 			break;
 	}
 
+	// pre-classify operands read directly from registers (see ptx_thread_info::get_operand_value)
+	for( std::vector<operand_info>::iterator o=m_operands.begin(); o != m_operands.end(); o++ ) 
+		o->resolve_plain_reg();
+	if( has_pred() ) {
+		m_pred_operand = get_pred();
+		m_pred_operand.resolve_plain_reg();
+	}
+
 	switch( m_cache_option ) {
 		case CA_OPTION: cache_op = CACHE_ALL; break;
 		case CG_OPTION: cache_op = CACHE_GLOBAL; break;
@@ -1290,7 +1312,7 @@ void ptx_thread_info::ptx_exec_inst( warp_inst_t &inst, unsigned lane_id)
 
 
 		if( pI->has_pred() ) {
-			const operand_info &pred = pI->get_pred();
+			const operand_info &pred = pI->pred_operand();
 			ptx_reg_t pred_value = get_operand_value(pred, pred, PRED_TYPE, this, 0);
 			if(pI->get_pred_mod() == -1) {
 				skip = (pred_value.pred & 0x0001) ^ pI->get_pred_neg(); //ptxplus inverts the zero flag
@@ -1309,11 +1331,11 @@ void ptx_thread_info::ptx_exec_inst( warp_inst_t &inst, unsigned lane_id)
 				*((warp_inst_t*)pJ) = inst; // copy active mask information
 				pI = pJ;
 			}
-			switch ( pI->get_opcode() ) {
-#define OP_DEF(OP,FUNC,STR,DST,CLASSIFICATION) case OP: FUNC(pI,this); op_classification = CLASSIFICATION; break;
-#include "opcodes.def"
-#undef OP_DEF
-				default: printf( "Execution error: Invalid opcode (0x%x)\n", pI->get_opcode() ); break;
+			if( pI->exec_fn() ) {
+				pI->exec_fn()(pI,this);
+				op_classification = pI->op_classification();
+			} else {
+				printf( "Execution error: Invalid opcode (0x%x)\n", pI->get_opcode() );
 			}
 			delete pJ;
 			pI = pI_saved;
@@ -1378,9 +1400,8 @@ void ptx_thread_info::ptx_exec_inst( warp_inst_t &inst, unsigned lane_id)
 				if (g_global_constant_pointer_sharing == 2){ //param accesses instantly completed
 				    insn_memaddr = 0xFEEBDAED;
 				} else if (g_global_constant_pointer_sharing == 1){
-				    extern application_id g_app_name;
-				    extern int global_constant_offset[12];
-				    if( insn_memaddr >= global_constant_offset[g_app_name] ) {
+				    const dcc_param_layout_t *layout = dcc_get_param_layout(m_func_info);
+				    if( insn_memaddr >= (addr_t)layout->const_pos ) {
 					insn_memaddr = 0xFEEBDAED;
 				    } else {
 					insn_memaddr += m_param_memory_base;
@@ -1496,6 +1517,369 @@ void ptx_thread_info::ptx_exec_inst( warp_inst_t &inst, unsigned lane_id)
 	//fprintf(stdout, "end ptx_exec_inst\n");
 }
 
+/*
+ * Warp-granular functional execution.
+ *
+ * For a small set of ALU instructions (add, sub, mul, mad, logic ops, shifts,
+ * mov, cvt, setp, selp) whose operands are plain registers, builtins or literals,
+ * the operands of all active lanes are gathered into per-warp arrays, the
+ * operation is applied once across the warp in a tight loop and the results
+ * are scattered back.  Everything else (memory ops, control flow, predicated
+ * destinations, ptxplus operand modifiers, debug tracing) returns false and is
+ * executed lane by lane through ptx_thread_info::ptx_exec_inst().
+ */
+
+static bool warp_exec_src_ok( const operand_info &op )
+{
+   if( op.get_double_operand_type() != 0 || op.get_operand_lohi() != 0 || op.get_operand_neg() )
+      return false;
+   if( op.get_addr_space() != undefined_space || op.is_vector() )
+      return false;
+   return op.is_reg() || op.is_builtin() || op.is_literal();
+}
+
+static bool warp_exec_int_type( int type )
+{
+   return type == S32_TYPE || type == U32_TYPE || type == S64_TYPE || type == U64_TYPE;
+}
+
+// integer and f32/f64 types, i.e. the ones with an entry in g_cvt_fn
+static bool warp_exec_cvt_type( int type )
+{
+   switch( type ) {
+   case S8_TYPE: case S16_TYPE: case S32_TYPE: case S64_TYPE:
+   case U8_TYPE: case U16_TYPE: case U32_TYPE: case U64_TYPE:
+   case F32_TYPE: case F64_TYPE:
+      return true;
+   default:
+      return false;
+   }
+}
+
+static bool warp_exec_supported( const ptx_instruction *pI )
+{
+   if( pI->is_exit() || pI->has_memory_read() || pI->has_memory_write() )
+      return false;
+
+   unsigned nsrc;
+   switch( pI->get_opcode() ) {
+   case MOV_OP: case CVT_OP: nsrc = 1; break;
+   case MAD_OP: case SELP_OP: nsrc = 3; break;
+   case ADD_OP: case SUB_OP: case MUL_OP: case AND_OP: case OR_OP: case XOR_OP:
+   case SHL_OP: case SHR_OP: case SETP_OP: nsrc = 2; break;
+   default: return false;
+   }
+   if( pI->get_num_operands() != nsrc+1 )
+      return false;
+
+   const operand_info &dst = pI->dst();
+   if( !dst.is_reg() || dst.is_vector() || dst.get_double_operand_type() != 0 ||
+       dst.get_operand_lohi() != 0 || dst.get_addr_space() != undefined_space )
+      return false;
+   for( unsigned n=1; n <= nsrc; n++ ) {
+      if( !warp_exec_src_ok(pI->operand_lookup(n)) )
+         return false;
+   }
+
+   int type = pI->get_type();
+   bool float_rn = (type == F32_TYPE || type == F64_TYPE) && pI->rounding_mode() == RN_OPTION && !pI->saturation_mode();
+   switch( pI->get_opcode() ) {
+   case ADD_OP:
+   case SUB_OP:
+      return warp_exec_int_type(type) || float_rn;
+   case MUL_OP:
+      if( type == F32_TYPE || type == F64_TYPE )
+         return float_rn;
+      if( pI->is_wide() )
+         return type == S32_TYPE || type == U32_TYPE;
+      return pI->is_lo() && warp_exec_int_type(type);
+   case MAD_OP:
+      return pI->is_lo() && (type == S32_TYPE || type == U32_TYPE);
+   case AND_OP:
+   case OR_OP:
+   case XOR_OP:
+      return type != PRED_TYPE && type != BB64_TYPE && type != BB128_TYPE && type != FF64_TYPE;
+   case SHL_OP:
+   case SHR_OP:
+      return type == B32_TYPE || type == U32_TYPE || type == B64_TYPE || type == U64_TYPE;
+   case SETP_OP:
+      if( warp_exec_int_type(type) ) {
+         switch( pI->get_cmpop() ) {
+         case EQ_OPTION: case NE_OPTION: case LT_OPTION: case LE_OPTION: case GT_OPTION: case GE_OPTION:
+            return true;
+         case LO_OPTION: case LS_OPTION: case HI_OPTION: case HS_OPTION:
+            return type == U32_TYPE || type == U64_TYPE;
+         default:
+            return false;
+         }
+      }
+      if( type == F32_TYPE || type == F64_TYPE ) {
+         switch( pI->get_cmpop() ) {
+         case EQ_OPTION: case NE_OPTION: case LT_OPTION: case LE_OPTION: case GT_OPTION: case GE_OPTION:
+         case EQU_OPTION: case NEU_OPTION: case LTU_OPTION: case LEU_OPTION: case GTU_OPTION: case GEU_OPTION:
+         case NUM_OPTION: case NAN_OPTION:
+            return true;
+         default:
+            return false;
+         }
+      }
+      return false;
+   case SELP_OP:
+      return true;
+   case CVT_OP:
+      return !pI->is_neg() && warp_exec_cvt_type(type) && warp_exec_cvt_type(pI->get_type2());
+   case MOV_OP:
+      if( type == BB64_TYPE || type == BB128_TYPE || type == FF64_TYPE )
+         return false;
+      return !(type == PRED_TYPE && pI->src1().is_literal());
+   default:
+      return false;
+   }
+}
+
+static inline float warp_exec_f32( unsigned long long v ) { ptx_reg_t r; r.u64 = v; return r.f32; }
+static inline double warp_exec_f64( unsigned long long v ) { ptx_reg_t r; r.u64 = v; return r.f64; }
+static inline unsigned long long warp_exec_from_f32( float f ) { ptx_reg_t r; r.f32 = f; return r.u64; }
+static inline unsigned long long warp_exec_from_f64( double f ) { ptx_reg_t r; r.f64 = f; return r.u64; }
+
+// same semantics as CmpOp(), restricted to the types accepted by warp_exec_supported()
+static inline bool warp_exec_cmp( int type, unsigned cmpop, unsigned long long a, unsigned long long b )
+{
+   if( type == F32_TYPE || type == F64_TYPE ) {
+      double x = (type == F32_TYPE)? warp_exec_f32(a) : warp_exec_f64(a);
+      double y = (type == F32_TYPE)? warp_exec_f32(b) : warp_exec_f64(b);
+      bool nan = (x != x) || (y != y);
+      switch( cmpop ) {
+      case EQ_OPTION:  return (x == y) && !nan;
+      case NE_OPTION:  return (x != y) && !nan;
+      case LT_OPTION:  return (x <  y) && !nan;
+      case LE_OPTION:  return (x <= y) && !nan;
+      case GT_OPTION:  return (x >  y) && !nan;
+      case GE_OPTION:  return (x >= y) && !nan;
+      case EQU_OPTION: return (x == y) || nan;
+      case NEU_OPTION: return (x != y) || nan;
+      case LTU_OPTION: return (x <  y) || nan;
+      case LEU_OPTION: return (x <= y) || nan;
+      case GTU_OPTION: return (x >  y) || nan;
+      case GEU_OPTION: return (x >= y) || nan;
+      case NUM_OPTION: return !nan;
+      case NAN_OPTION: return nan;
+      default: assert(0); return false;
+      }
+   }
+   if( type == S32_TYPE || type == S64_TYPE ) {
+      long long x = (type == S32_TYPE)? (long long)(int)a : (long long)a;
+      long long y = (type == S32_TYPE)? (long long)(int)b : (long long)b;
+      switch( cmpop ) {
+      case EQ_OPTION: return x == y;
+      case NE_OPTION: return x != y;
+      case LT_OPTION: return x <  y;
+      case LE_OPTION: return x <= y;
+      case GT_OPTION: return x >  y;
+      case GE_OPTION: return x >= y;
+      default: assert(0); return false;
+      }
+   }
+   unsigned long long x = (type == U32_TYPE)? (a & 0xFFFFFFFFULL) : a;
+   unsigned long long y = (type == U32_TYPE)? (b & 0xFFFFFFFFULL) : b;
+   switch( cmpop ) {
+   case EQ_OPTION: return x == y;
+   case NE_OPTION: return x != y;
+   case LT_OPTION: case LO_OPTION: return x <  y;
+   case LE_OPTION: case LS_OPTION: return x <= y;
+   case GT_OPTION: case HI_OPTION: return x >  y;
+   case GE_OPTION: case HS_OPTION: return x >= y;
+   default: assert(0); return false;
+   }
+}
+
+static void warp_exec_compute( const ptx_instruction *pI, unsigned n,
+                               const unsigned long long *a, const unsigned long long *b,
+                               const unsigned long long *c, unsigned long long *d )
+{
+   const unsigned long long M32 = 0xFFFFFFFFULL;
+   int type = pI->get_type();
+   bool b32 = (type == S32_TYPE || type == U32_TYPE || type == B32_TYPE);
+   unsigned t;
+
+   switch( pI->get_opcode() ) {
+   case ADD_OP:
+      if( type == F32_TYPE )      for( t=0; t < n; t++ ) d[t] = warp_exec_from_f32( warp_exec_f32(a[t]) + warp_exec_f32(b[t]) );
+      else if( type == F64_TYPE ) for( t=0; t < n; t++ ) d[t] = warp_exec_from_f64( warp_exec_f64(a[t]) + warp_exec_f64(b[t]) );
+      else if( b32 )              for( t=0; t < n; t++ ) d[t] = (a[t] & M32) + (b[t] & M32); // keeps carry bit like add_impl
+      else                        for( t=0; t < n; t++ ) d[t] = a[t] + b[t];
+      break;
+   case SUB_OP:
+      if( type == F32_TYPE )      for( t=0; t < n; t++ ) d[t] = warp_exec_from_f32( warp_exec_f32(a[t]) - warp_exec_f32(b[t]) );
+      else if( type == F64_TYPE ) for( t=0; t < n; t++ ) d[t] = warp_exec_from_f64( warp_exec_f64(a[t]) - warp_exec_f64(b[t]) );
+      else if( b32 )              for( t=0; t < n; t++ ) d[t] = (a[t] & M32) - (b[t] & M32) + 0x100000000ULL; // see sub_impl
+      else                        for( t=0; t < n; t++ ) d[t] = a[t] - b[t];
+      break;
+   case MUL_OP:
+      if( type == F32_TYPE )      for( t=0; t < n; t++ ) d[t] = warp_exec_from_f32( warp_exec_f32(a[t]) * warp_exec_f32(b[t]) );
+      else if( type == F64_TYPE ) for( t=0; t < n; t++ ) d[t] = warp_exec_from_f64( warp_exec_f64(a[t]) * warp_exec_f64(b[t]) );
+      else if( pI->is_wide() && type == S32_TYPE )
+         for( t=0; t < n; t++ ) d[t] = (unsigned long long)( (long long)(int)a[t] * (long long)(int)b[t] );
+      else if( pI->is_wide() )
+         for( t=0; t < n; t++ ) d[t] = (a[t] & M32) * (b[t] & M32);
+      else if( b32 )              for( t=0; t < n; t++ ) d[t] = (a[t] * b[t]) & M32;
+      else                        for( t=0; t < n; t++ ) d[t] = a[t] * b[t];
+      break;
+   case MAD_OP:
+      for( t=0; t < n; t++ ) d[t] = (a[t] * b[t] + c[t]) & M32;
+      break;
+   case AND_OP: for( t=0; t < n; t++ ) d[t] = a[t] & b[t]; break;
+   case OR_OP:  for( t=0; t < n; t++ ) d[t] = a[t] | b[t]; break;
+   case XOR_OP: for( t=0; t < n; t++ ) d[t] = a[t] ^ b[t]; break;
+   case SHL_OP:
+      if( b32 ) for( t=0; t < n; t++ ) d[t] = ((unsigned)b[t] >= 32)? 0 : (unsigned)((unsigned)a[t] << (unsigned)b[t]);
+      else      for( t=0; t < n; t++ ) d[t] = ((unsigned)b[t] >= 64)? 0 : (a[t] << (b[t] & 63));
+      break;
+   case SHR_OP:
+      if( b32 ) for( t=0; t < n; t++ ) d[t] = ((unsigned)b[t] >= 32)? 0 : (unsigned)((unsigned)a[t] >> (unsigned)b[t]);
+      else      for( t=0; t < n; t++ ) d[t] = ((unsigned)b[t] >= 64)? 0 : (a[t] >> (b[t] & 63));
+      break;
+   case SETP_OP: {
+      // ptxplus convention: predicate value 1 means the zero flag is set (false)
+      unsigned cmpop = pI->get_cmpop();
+      for( t=0; t < n; t++ ) d[t] = warp_exec_cmp(type,cmpop,a[t],b[t])? 0 : 1;
+      break;
+   }
+   case SELP_OP:
+      for( t=0; t < n; t++ ) d[t] = (c[t] & 1)? b[t] : a[t];
+      break;
+   case MOV_OP:
+      for( t=0; t < n; t++ ) d[t] = a[t];
+      break;
+   case CVT_OP: {
+      // same conversion routine as cvt_impl(), decoded once for the warp
+      int to_sign, from_sign;
+      size_t from_width, to_width;
+      unsigned src_fmt = type_info_key::type_decode(pI->get_type2(), from_width, from_sign);
+      unsigned dst_fmt = type_info_key::type_decode(type, to_width, to_sign);
+      ptx_reg_t (*fn)( ptx_reg_t, unsigned, unsigned, int, int, int ) = g_cvt_fn[src_fmt][dst_fmt];
+      if( fn == NULL ) {
+         for( t=0; t < n; t++ ) d[t] = a[t];
+      } else {
+         unsigned rounding_mode = pI->rounding_mode();
+         unsigned saturation_mode = pI->saturation_mode();
+         for( t=0; t < n; t++ ) {
+            ptx_reg_t x;
+            x.u64 = a[t];
+            d[t] = fn(x, from_width, to_width, to_sign, rounding_mode, saturation_mode).u64;
+         }
+      }
+      break;
+   }
+   default:
+      assert(0);
+      break;
+   }
+}
+
+bool ptx_warp_exec_inst( core_t *core, warp_inst_t &inst, unsigned warpId )
+{
+   if( g_debug_execution >= 5 || gpgpu_ptx_instruction_classification )
+      return false;
+   if( core->get_gpu()->get_config().get_ptx_inst_debug_to_file() )
+      return false;
+
+   const ptx_instruction *pI = function_info::pc_to_instruction(inst.pc);
+   if( pI == NULL || !warp_exec_supported(pI) )
+      return false;
+
+   const unsigned warp_size = core->get_warp_size();
+   assert( warp_size <= MAX_WARP_SIZE );
+   if( warpId == (unsigned)-1 )
+      warpId = inst.warp_id();
+   ptx_thread_info **thread = &core->m_thread[warp_size*warpId];
+
+   const active_mask_t active = inst.get_active_mask();
+   if( active.none() )
+      return false;
+
+   // per-lane prologue and guard predicate, exactly as in ptx_exec_inst()
+   bool exec[MAX_WARP_SIZE];
+   for( unsigned t=0; t < warp_size; t++ ) {
+      exec[t] = false;
+      if( !active.test(t) )
+         continue;
+      ptx_thread_info *thd = thread[t];
+      addr_t pc = thd->next_instr();
+      assert( pc == inst.pc );
+      thd->set_npc( pc + pI->inst_size() );
+      thd->clearRPC();
+      thd->m_last_set_operand_value.u64 = 0;
+      if( thd->is_done() ) {
+         printf("attempted to execute instruction on a thread that is already done.\n");
+         assert(0);
+      }
+      bool skip = false;
+      if( pI->has_pred() ) {
+         const operand_info &pred = pI->pred_operand();
+         ptx_reg_t pred_value = thd->get_operand_value(pred, pred, PRED_TYPE, thd, 0);
+         if( pI->get_pred_mod() == -1 )
+            skip = (pred_value.pred & 0x0001) ^ pI->get_pred_neg();
+         else
+            skip = !pred_lookup(pI->get_pred_mod(), pred_value.pred & 0x000F);
+      }
+      exec[t] = !skip;
+   }
+
+   // gather: registers are only read for executing lanes since get_reg() has side effects
+   unsigned long long src[3][MAX_WARP_SIZE];
+   unsigned long long result[MAX_WARP_SIZE];
+   const operand_info &dst = pI->dst();
+   int type = (pI->get_opcode() == CVT_OP)? pI->get_type2() : pI->get_type(); // operand type of the sources
+   unsigned nsrc = pI->get_num_operands() - 1;
+   for( unsigned n=0; n < nsrc; n++ ) {
+      const operand_info &op = pI->operand_lookup(n+1);
+      for( unsigned t=0; t < warp_size; t++ ) {
+         if( !exec[t] )
+            src[n][t] = 0;
+         else if( op.is_reg() )
+            src[n][t] = thread[t]->get_reg( op.get_symbol() ).u64;
+         else
+            src[n][t] = thread[t]->get_operand_value( op, dst, type, thread[t], 1 ).u64;
+      }
+   }
+
+   warp_exec_compute( pI, warp_size, src[0], src[1], src[2], result );
+
+   // scatter results and retire each lane as ptx_exec_inst() + checkExecutionStatusAndUpdate() would
+   for( unsigned t=0; t < warp_size; t++ ) {
+      if( !active.test(t) )
+         continue;
+      ptx_thread_info *thd = thread[t];
+      if( exec[t] ) {
+         ptx_reg_t value;
+         value.u64 = result[t];
+         thd->set_reg( dst.get_symbol(), value );
+      } else {
+         inst.set_not_active(t);
+      }
+      thd->update_pc();
+      g_ptx_sim_num_insn++;
+      if( !thd->isInFunctionalSimulationMode() )
+         ptx_file_line_stats_add_exec_count(pI);
+      if ( (g_ptx_sim_num_insn % 100000) == 0 ) {
+         dim3 ctaid = thd->get_ctaid();
+         dim3 tid = thd->get_tid();
+         printf("GPGPU-Sim PTX: %u instructions simulated : ctaid=(%u,%u,%u) tid=(%u,%u,%u)\n",
+                g_ptx_sim_num_insn, ctaid.x,ctaid.y,ctaid.z,tid.x,tid.y,tid.z );
+         fflush(stdout);
+      }
+      if( exec[t] ) {
+         inst.space = undefined_space;
+         inst.set_addr(t, 0xFEEBDAED);
+         inst.data_size = 0;
+         assert( inst.memory_op == no_memory_op );
+      }
+      core->checkExecutionStatusAndUpdate(inst, t, warp_size*warpId+t);
+   }
+   return true;
+}
+
 void set_param_gpgpu_num_shaders(int num_shaders)
 {
 	gpgpu_param_num_shaders = num_shaders;
@@ -1516,6 +1900,27 @@ std::map<unsigned,memory_space*> shared_memory_lookup;
 std::map<unsigned,ptx_cta_info*> ptx_cta_lookup;
 std::map<unsigned,std::map<unsigned,memory_space*> > local_memory_lookup;
 
+// finished ptx_thread_info objects kept for reuse by later CTAs, so child
+// heavy runs do not allocate and free one object (plus its register frame
+// and call stack) per simulated thread
+static std::vector<ptx_thread_info *> g_ptx_thread_pool;
+
+static ptx_thread_info *alloc_ptx_thread( kernel_info_t &kernel )
+{
+	if ( g_ptx_thread_pool.empty() ) 
+		return new ptx_thread_info(kernel);
+	ptx_thread_info *thd = g_ptx_thread_pool.back();
+	g_ptx_thread_pool.pop_back();
+	thd->reset(kernel);
+	return thd;
+}
+
+static void free_ptx_thread( ptx_thread_info *thd )
+{
+	g_ptx_thread_info_delete_count++;
+	g_ptx_thread_pool.push_back(thd);
+}
+
 unsigned ptx_sim_init_thread( kernel_info_t &kernel,
 		ptx_thread_info** thread_info,
 		int sid,
@@ -1542,7 +1947,7 @@ unsigned ptx_sim_init_thread( kernel_info_t &kernel,
 			fflush(stdout);
 		}
 		thd->m_cta_info->register_deleted_thread(thd);
-		delete thd;
+		free_ptx_thread(thd);
 		*thread_info = NULL;
 	}
 
@@ -1612,7 +2017,7 @@ unsigned ptx_sim_init_thread( kernel_info_t &kernel,
 		dim3 tid3d = kernel.get_next_thread_id_3d();
 		kernel.increment_thread_id();
 		new_tid += tid;
-		ptx_thread_info *thd = new ptx_thread_info(kernel);
+		ptx_thread_info *thd = alloc_ptx_thread(kernel);
 
 		memory_space *local_mem = NULL;
 		std::map<unsigned,memory_space*>::iterator l = local_mem_lookup.find(new_tid);
@@ -1664,7 +2069,7 @@ unsigned ptx_sim_init_thread( kernel_info_t &kernel,
 	int agg_group_id = kernel.get_next_agg_group_id();
 	unsigned block_id = kernel.get_next_block_id();
 	int kernel_queue_entry;
-	if( agg_group_id >= 0 ){
+	if( agg_group_id >= 0 && !kernel.is_warp_batch_agg_group(agg_group_id) ){ //batched CDP launches have no kernel metadata
 	    dim3 agg_grid_dim = kernel.get_grid_dim(agg_group_id);
 	    kernel_queue_entry = kernel.get_kernel_queue_entry(agg_group_id);
 	    if( block_id == 0 ){// agg_block_group and 1st block, check for extra meta data load latency
@@ -1848,10 +2253,15 @@ void gpgpu_ptx_sim_memcpy_symbol(const char *hostVar, const void *src, size_t co
 	}
 	printf("GPGPU-Sim PTX: gpgpu_ptx_sim_memcpy_symbol: copying %s memory %zu bytes %s symbol %s+%zu @0x%x ...\n", 
 			mem_name, count, (to?" to ":"from"), sym_name.c_str(), offset, dst );
-	for ( unsigned n=0; n < count; n++ ) {
-		if( to ) mem->write(dst+n,1,((char*)src)+n,NULL,NULL); 
-		else mem->read(dst+n,1,((char*)src)+n); 
+	sim_checkpoint *ckpt = gpu->get_checkpoint();
+	if( to || ckpt == NULL || !ckpt->replay_host_read((void*)src,count) ) {
+		for ( unsigned n=0; n < count; n++ ) {
+			if( to ) mem->write(dst+n,1,((char*)src)+n,NULL,NULL); 
+			else mem->read(dst+n,1,((char*)src)+n); 
+		}
 	}
+	if( !to && ckpt ) 
+		ckpt->record_host_read(src,count);
 	fflush(stdout);
 }
 
@@ -2043,6 +2453,7 @@ void functionalCoreSim::executeWarp(unsigned i, bool &allAtBarrier, bool & someO
 	if(!m_warpAtBarrier[i] && m_liveThreadCount[i]!=0){
 		warp_inst_t inst =getExecuteWarp(i);
 		execute_warp_inst_t(inst,i);
+		if(m_gpu->get_sampler()) m_gpu->get_sampler()->functional_inst(inst);
 		if(inst.isatomic()) inst.do_atomic(true);
 		if(inst.op==BARRIER_OP || inst.op==MEMORY_BARRIER_OP ) m_warpAtBarrier[i]=true;
 		updateSIMTStack( i, &inst );
@@ -73,6 +73,7 @@ unsigned ptx_sim_init_thread( kernel_info_t &kernel,
                               gpgpu_t *gpu,
                               bool functionalSimulationMode = false);
 const warp_inst_t *ptx_fetch_inst( address_type pc );
+bool ptx_warp_exec_inst( class core_t *core, warp_inst_t &inst, unsigned warpId );
 const struct gpgpu_ptx_sim_kernel_info* ptx_sim_kernel_info(const class function_info *kernel);
 void ptx_print_insn( address_type pc, FILE *fp );
 std::string ptx_get_insn_str( address_type pc );
@@ -2,6 +2,8 @@
 //Defines CUDA device runtime APIs for CDP support
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <map>
 
 #define __CUDA_RUNTIME_API_H__
@@ -110,6 +112,7 @@ std::map<void *, device_launch_config_t> g_cuda_device_launch_param_map;
 std::list<device_launch_operation_t> g_cuda_device_launch_op;
 extern stream_manager *g_stream_manager;
 bool g_agg_blocks_support = false;
+bool g_cdp_warp_launch_batching = false;
 unsigned long long g_total_ld_inst_warp = 0;
 unsigned long long g_total_st_inst_warp = 0;
 unsigned long long g_total_ld_cache_line = 0;
@@ -215,6 +218,8 @@ unsigned long long num_cycles_exist_offchip_metadata = 0;
 unsigned long long accumulate_num_offchip_metadata = 0;
 unsigned long long maximum_num_offchip_metadata = 0;
 bool g_child_aware_smk_scheduling;
+char *g_dcc_consolidation_policy = NULL;
+unsigned g_dcc_timeout_threshold = 200;
 bool enough_pending_threads = false;
 bool g_param_acc_unified_L1;
 
@@ -249,6 +254,440 @@ std::string sp_k2("calc_pi_CdpKernel");
 std::string mst_k1("find1_CdpKernel");
 std::string mst_k2("find2_CdpKernel");
 
+//Po-Han DCC: child parameter layouts
+char *g_dcc_param_layout_file = NULL;
+
+struct dcc_param_layout_spec_t {
+   std::string kernel;   // matched as a substring of the child kernel name
+   unsigned line;        // line in the layout file, for error messages
+   std::map<std::string,std::string> fields;
+};
+
+static std::list<dcc_param_layout_spec_t> *dcc_param_layout_specs = NULL;
+static std::map<const function_info*,dcc_param_layout_t> dcc_param_layouts;
+
+/* One child kernel per line:
+ *   <kernel name> offset=<param#> count=<param#> [shift=<param#>,...] [stride=<param#>:<stride param#>]
+ *                 [const=<param#>] [constpc=<pc>[-<pc>],...] [size=<bytes>] [nosplit] [same_parent_block]
+ * where <param#> is the index of the parameter in the kernel's PTX .param list and
+ * constpc lists the PCs (or inclusive PC ranges) of the loads of the const params. */
+static void load_dcc_param_layout_file()
+{
+   dcc_param_layout_specs = new std::list<dcc_param_layout_spec_t>;
+   if( g_dcc_param_layout_file == NULL || g_dcc_param_layout_file[0] == '\0' ) 
+      return;
+   std::ifstream in(g_dcc_param_layout_file);
+   if( !in.is_open() ) {
+      printf("GPGPU-Sim PTX: ERROR ** cannot open DCC parameter layout file \'%s\'\n", g_dcc_param_layout_file);
+      abort();
+   }
+   std::string line;
+   unsigned line_no = 0;
+   while( std::getline(in,line) ) {
+      line_no++;
+      if( line.empty() || line[0] == '#' ) 
+         continue;
+      std::istringstream tokens(line);
+      dcc_param_layout_spec_t spec;
+      spec.line = line_no;
+      if( !(tokens >> spec.kernel) ) 
+         continue;
+      std::string tok;
+      while( tokens >> tok ) {
+         size_t eq = tok.find('=');
+         if( eq == std::string::npos ) 
+            spec.fields[tok] = "";
+         else
+            spec.fields[tok.substr(0,eq)] = tok.substr(eq+1);
+      }
+      dcc_param_layout_specs->push_back(spec);
+   }
+   DEV_RUNTIME_REPORT("DCC: loaded " << dcc_param_layout_specs->size() << " child parameter layouts from " << g_dcc_param_layout_file);
+}
+
+static void dcc_param_layout_error( const dcc_param_layout_spec_t &spec, const char *msg, const std::string &value )
+{
+   printf("GPGPU-Sim PTX: ERROR ** %s \'%s\' for kernel \'%s\' in DCC parameter layout file \'%s\' line %u\n", 
+          msg, value.c_str(), spec.kernel.c_str(), g_dcc_param_layout_file, spec.line);
+   abort();
+}
+
+// kernels without an entry in the layout file fall back to the -application_name tables
+static void dcc_param_layout_error( const std::string &kernel, const char *msg, const std::string &value )
+{
+   printf("GPGPU-Sim PTX: ERROR ** %s \'%s\' for kernel \'%s\' with -application_name %d; describe the kernel in -dcc_param_layout_file\n", 
+          msg, value.c_str(), kernel.c_str(), (int)g_app_name);
+   abort();
+}
+
+static unsigned dcc_param_layout_pc( const dcc_param_layout_spec_t &spec, const std::string &value )
+{
+   char *end;
+   unsigned long pc = strtoul(value.c_str(), &end, 0);
+   if( value.empty() || *end != '\0' ) 
+      dcc_param_layout_error(spec, "invalid PC", value);
+   return pc;
+}
+
+// byte offset of the parameter whose index is given by 'value'
+static unsigned dcc_param_layout_arg( function_info *kernel, const dcc_param_layout_spec_t &spec, const std::string &value )
+{
+   char *end;
+   long n = strtol(value.c_str(), &end, 10);
+   if( value.empty() || *end != '\0' || n < 0 || (unsigned long)n >= kernel->num_args() ) 
+      dcc_param_layout_error(spec, "invalid parameter index", value);
+   return kernel->get_arg_offset(n);
+}
+
+static void resolve_dcc_param_layout( function_info *kernel, const dcc_param_layout_spec_t &spec, dcc_param_layout_t &layout )
+{
+   std::map<std::string,std::string>::const_iterator f;
+   if( !spec.fields.count("offset") ) 
+      dcc_param_layout_error(spec, "missing field", "offset");
+   if( !spec.fields.count("count") ) 
+      dcc_param_layout_error(spec, "missing field", "count");
+   layout.offset_pos = dcc_param_layout_arg( kernel, spec, spec.fields.find("offset")->second );
+   layout.total_thread_pos = dcc_param_layout_arg( kernel, spec, spec.fields.find("count")->second );
+   layout.shift_pos.push_back(layout.offset_pos);
+   if( (f = spec.fields.find("shift")) != spec.fields.end() ) {
+      std::istringstream list(f->second);
+      std::string n;
+      while( std::getline(list,n,',') ) 
+         layout.shift_pos.push_back( dcc_param_layout_arg(kernel, spec, n) );
+   }
+   if( (f = spec.fields.find("stride")) != spec.fields.end() ) {
+      size_t colon = f->second.find(':');
+      if( colon == std::string::npos ) 
+         dcc_param_layout_error(spec, "stride needs <param#>:<stride param#>, got", f->second);
+      layout.strided_pos = dcc_param_layout_arg( kernel, spec, f->second.substr(0,colon) );
+      layout.stride_pos = dcc_param_layout_arg( kernel, spec, f->second.substr(colon+1) );
+   }
+   if( (f = spec.fields.find("const")) != spec.fields.end() ) 
+      layout.const_pos = dcc_param_layout_arg( kernel, spec, f->second );
+   if( (f = spec.fields.find("constpc")) != spec.fields.end() ) {
+      std::istringstream list(f->second);
+      std::string n;
+      while( std::getline(list,n,',') ) {
+         size_t dash = n.find('-');
+         unsigned first = dcc_param_layout_pc( spec, n.substr(0,dash) );
+         unsigned last = (dash == std::string::npos)? first : dcc_param_layout_pc( spec, n.substr(dash+1) );
+         if( last < first ) 
+            dcc_param_layout_error(spec, "empty PC range", n);
+         layout.const_pc.push_back( std::make_pair(first,last) );
+      }
+   }
+   if( (f = spec.fields.find("size")) != spec.fields.end() ) {
+      char *end;
+      long size = strtol(f->second.c_str(), &end, 10);
+      if( f->second.empty() || *end != '\0' || size <= 0 ) 
+         dcc_param_layout_error(spec, "invalid parameter size", f->second);
+      layout.param_size = size;
+   }
+   layout.splittable = (spec.fields.count("nosplit") == 0);
+   layout.same_parent_block = (spec.fields.count("same_parent_block") != 0);
+}
+
+// hand-coded layouts of the benchmark child kernels, selected by -application_name
+static void builtin_dcc_param_layout( const std::string &name, dcc_param_layout_t &layout )
+{
+   layout.offset_pos = per_kernel_offset[g_app_name];
+   layout.total_thread_pos = 4;
+   std::ostringstream app_id;
+   app_id << (int)g_app_name;
+   if( (unsigned)g_app_name >= sizeof(global_constant_offset)/sizeof(global_constant_offset[0]) ) 
+      dcc_param_layout_error(name, "unknown application id", app_id.str());
+   layout.const_pos = global_constant_offset[g_app_name];
+   const unsigned *pc = global_constant_pc[g_app_name];
+   if( g_app_name == MST || g_app_name == KMEANS || g_app_name == SP ) {
+      layout.const_pc.push_back( std::make_pair(pc[0],pc[1]) );
+      layout.const_pc.push_back( std::make_pair(pc[2],pc[3]) );
+   } else {
+      for( unsigned i = 0; i < 12; i++ ) 
+         layout.const_pc.push_back( std::make_pair(pc[i],pc[i]) );
+   }
+   layout.shift_pos.push_back(layout.offset_pos);
+   switch(g_app_name){
+   case BFS:
+      //[offset_a (4B), total_thread (4B), offset_b (4B), base_a (8B), base_b (8B)]
+      layout.shift_pos.push_back(8);
+      layout.param_size = 28;
+      break;
+   case MST:
+      //find1: [offset (4B), total_thread (4B), var (4Bx2), base (104B, 32B, 8B)]
+      //find2: [offset (4B), total_thread (4B), var (4Bx2), base (104B, 32B, 8Bx2)]
+      if( name.find(mst_k1) != std::string::npos ) layout.param_size = 160;
+      else if( name.find(mst_k2) != std::string::npos ) layout.param_size = 168;
+      else dcc_param_layout_error(name, "unsupported child kernel", "minimum spanning tree");
+      layout.splittable = false;
+      break;
+   case JOIN:
+      //[offset_a (4B), total_thread (4B), offset_b (4B), var (4B), base_a~b (8Bx2)]
+      layout.shift_pos.push_back(8);
+      layout.param_size = 32;
+      break;
+   case SSSP:
+      //[offset (4B), total_thread (4B), var (4B), base_a~d (8Bx4), const_a (8B), const_b (4B)]
+      layout.param_size = 60;
+      break;
+   case COLOR:
+      //[offset (4B), total_thread (4B), var (8B), base_a~d (8Bx3)]
+      layout.param_size = 48;
+      break;
+   case MIS:
+      //mis1: [offset (4B), total_thread (4B), var (8B), base_a~c (8Bx3)]
+      //mis2: [offset (4B), total_thread (4B), base_a~c (8Bx3)]
+      if( name.find(mis_k1) != std::string::npos ) layout.param_size = 40;
+      else if( name.find(mis_k2) != std::string::npos ) layout.param_size = 32;
+      break;
+   case PAGERANK:
+      //inicsr: [offset (4B), total_thread (4B), base_a~c (8Bx3)]
+      //spmv_csr_scalar: [offset (4B), total_thread (4B), var (8B), base_a~c (8Bx3)]
+      if( name.find(pr_k1) != std::string::npos ) layout.param_size = 32;
+      else if( name.find(pr_k2) != std::string::npos ) layout.param_size = 40;
+      else dcc_param_layout_error(name, "unsupported child kernel", "pagerank");
+      break;
+   case KMEANS:
+      //[total_thread (4B), offset_2 (4B), stride (4B), offset_1 (4B), var (8B), base_a~b (8Bx2)]
+      layout.total_thread_pos = 0;
+      layout.strided_pos = 4;
+      layout.stride_pos = 8;
+      layout.param_size = 40;
+      layout.splittable = false;
+      break;
+   case SP:
+      //update_bias: [offset (4B), total_thread (4B), var (8Bx3), base (48B, 48B, 64B)]
+      //calc_pi_value: [offset (4B), total_thread (4B), var (4Bx2, 8Bx3), base (48B, 48B, 64B)]
+      if( name.find(sp_k1) != std::string::npos ) layout.param_size = 192;
+      else if( name.find(sp_k2) != std::string::npos ) layout.param_size = 208;
+      else dcc_param_layout_error(name, "unsupported child kernel", "survey-propagation");
+      layout.splittable = false;
+      break;
+   case BC:
+      //[offset (4B), total_thread (4B), base_a~d (8Bx4), var (4B), const (4B)]
+      layout.param_size = 48;
+      if( name.find(bc_k2) != std::string::npos ) { //kernel backtrack
+         layout.same_parent_block = true;
+         layout.splittable = false;
+      }
+      break;
+   case SPMV:
+      //[offset (4B), total_thread (4B), var (8B), base_a~b (8Bx2)]
+      layout.param_size = 32;
+      break;
+   case BL:
+      //[offset (4B), total_thread (4B), base_a~c (8Bx3)]
+      layout.param_size = 32;
+      break;
+   default:
+      dcc_param_layout_error(name, "no built-in layout for application id", app_id.str());
+      break;
+   }
+}
+
+const dcc_param_layout_t *dcc_get_param_layout( function_info *kernel )
+{
+   const dcc_param_layout_t *cached = kernel->get_dcc_param_layout();
+   if( cached ) 
+      return cached;
+   if( dcc_param_layout_specs == NULL ) 
+      load_dcc_param_layout_file();
+
+   dcc_param_layout_t &layout = dcc_param_layouts[kernel];
+   layout.offset_pos = 0;
+   layout.total_thread_pos = 4;
+   layout.strided_pos = -1;
+   layout.stride_pos = -1;
+   layout.const_pos = -1;
+   layout.param_size = kernel->get_args_aligned_size();
+   layout.splittable = true;
+   layout.same_parent_block = false;
+
+   const std::string &name = kernel->get_name();
+   std::list<dcc_param_layout_spec_t>::const_iterator s;
+   for( s = dcc_param_layout_specs->begin(); s != dcc_param_layout_specs->end(); s++ ) {
+      if( name.find(s->kernel) != std::string::npos ) 
+         break;
+   }
+   if( s != dcc_param_layout_specs->end() ) 
+      resolve_dcc_param_layout(kernel, *s, layout);
+   else
+      builtin_dcc_param_layout(name, layout);
+
+   kernel->set_dcc_param_layout(&layout);
+   return &layout;
+}
+
+// true if the instruction at pc loads a parameter shared by all children of its kernel; only
+// kernels whose layout is already known are checked (children get it before they run)
+bool dcc_is_global_constant_pc( unsigned pc )
+{
+   extern std::map<unsigned,function_info*> g_pc_to_finfo;
+   std::map<unsigned,function_info*>::const_iterator f = g_pc_to_finfo.find(pc);
+   if( f == g_pc_to_finfo.end() ) 
+      return false;
+   const dcc_param_layout_t *layout = f->second->get_dcc_param_layout();
+   if( layout == NULL ) 
+      return false;
+   for( unsigned r = 0; r < layout->const_pc.size(); r++ ) {
+      if( pc >= layout->const_pc[r].first && pc <= layout->const_pc[r].second ) 
+         return true;
+   }
+   return false;
+}
+
+/* Po-Han DKC: kernel distributor index
+ * g_cuda_dcc_kernel_distributor keeps the entries in arrival order; the maps below index it so that
+ * launching, candidate selection and merging do not rescan the whole list every cycle.
+ * Activated (valid) entries are bucketed by (child function, parent kernel), ordered by arrival,
+ * with a per-parent-block sub-index for cudaDeviceSynchronize. */
+typedef std::list<dcc_kernel_distributor_t>::iterator dcc_kd_iter_t;
+typedef std::map<unsigned long long, dcc_kd_iter_t> dcc_kd_seq_map_t;
+typedef std::pair<const function_info *, kernel_info_t *> dcc_kd_key_t;
+
+struct dcc_kd_bucket_t {
+   dcc_kd_seq_map_t entries;
+   std::map<unsigned, dcc_kd_seq_map_t> block_entries;
+};
+
+static std::map<dcc_kd_key_t, dcc_kd_bucket_t> g_dcc_kd_buckets;
+static std::map<void *, dcc_kd_iter_t> g_dcc_kd_by_param_buffer;	// pre-allocated, not launched yet
+static std::map<kernel_info_t *, dcc_kd_iter_t> g_dcc_kd_by_grid;
+static std::map<std::pair<kernel_info_t *, unsigned>, unsigned> g_dcc_kd_block_count;	// entries per parent block
+static unsigned long long g_dcc_kd_next_seq = 0;
+
+static dcc_kd_key_t dcc_kd_key( dcc_kernel_distributor_t &entry )
+{
+   return dcc_kd_key_t(entry.kernel_grid->entry(), entry.kernel_grid->get_parent());
+}
+
+static void dcc_kd_insert( const dcc_kernel_distributor_t &entry )
+{
+   dcc_kd_iter_t it = g_cuda_dcc_kernel_distributor.insert(g_cuda_dcc_kernel_distributor.end(), entry);
+   it->kd_seq = g_dcc_kd_next_seq++;
+   assert(g_dcc_kd_by_param_buffer.find(it->parameter_buffer) == g_dcc_kd_by_param_buffer.end());
+   g_dcc_kd_by_param_buffer[it->parameter_buffer] = it;
+   g_dcc_kd_by_grid[it->kernel_grid] = it;
+   g_dcc_kd_block_count[std::make_pair(it->kernel_grid->get_parent(), it->parent_block_idx)]++;
+}
+
+//parameters are ready: make the entry visible to consolidation
+static void dcc_kd_activate( dcc_kd_iter_t it )
+{
+   g_dcc_kd_by_param_buffer.erase(it->parameter_buffer);
+   dcc_kd_bucket_t &bucket = g_dcc_kd_buckets[dcc_kd_key(*it)];
+   bucket.entries[it->kd_seq] = it;
+   bucket.block_entries[it->parent_block_idx][it->kd_seq] = it;
+}
+
+//remove an entry from the distributor
+static void dcc_kd_erase( dcc_kd_iter_t it )
+{
+   std::map<void *, dcc_kd_iter_t>::iterator pb = g_dcc_kd_by_param_buffer.find(it->parameter_buffer);
+   if( pb != g_dcc_kd_by_param_buffer.end() && pb->second == it )
+      g_dcc_kd_by_param_buffer.erase(pb);
+
+   std::map<dcc_kd_key_t, dcc_kd_bucket_t>::iterator b = g_dcc_kd_buckets.find(dcc_kd_key(*it));
+   if( b != g_dcc_kd_buckets.end() && b->second.entries.erase(it->kd_seq) ){
+      dcc_kd_bucket_t &bucket = b->second;
+      std::map<unsigned, dcc_kd_seq_map_t>::iterator blk = bucket.block_entries.find(it->parent_block_idx);
+      blk->second.erase(it->kd_seq);
+      if( blk->second.empty() ) bucket.block_entries.erase(blk);
+      if( bucket.entries.empty() ) g_dcc_kd_buckets.erase(b);
+   }
+
+   std::pair<kernel_info_t *, unsigned> block_key(it->kernel_grid->get_parent(), it->parent_block_idx);
+   if( --g_dcc_kd_block_count[block_key] == 0 ) g_dcc_kd_block_count.erase(block_key);
+   g_dcc_kd_by_grid.erase(it->kernel_grid);
+   g_cuda_dcc_kernel_distributor.erase(it);
+}
+
+void dcc_kernel_distributor_retire( kernel_info_t *kernel )
+{
+   std::map<kernel_info_t *, dcc_kd_iter_t>::iterator g = g_dcc_kd_by_grid.find(kernel);
+   if( g == g_dcc_kd_by_grid.end() ) return;
+   fprintf(stdout, "DCC: retires child kernel %d at entry %llu\n", kernel->get_uid(), g->second->kd_seq);
+   dcc_kd_erase(g->second);
+   fprintf(stdout, "DCC: kernel distributor now has %zu entries\n", g_cuda_dcc_kernel_distributor.size());
+   fflush(stdout);
+}
+
+bool dcc_consolidation_policy::engine_available( unsigned long long cycle ) const
+{
+   return !g_estimate_offchip_metadata_load_latency || kernel_consolidation_engine_busy_until <= cycle;
+}
+
+void dcc_consolidation_policy::launch_shape( function_info *child, unsigned &threads_per_block, unsigned &threads_per_kernel ) const
+{
+   // block size: smallest warp multiple that still lets max_cta_per_core blocks fill an SM
+   unsigned int reg_usage = ptx_kernel_nregs(child);
+   unsigned int reg_per_SM = m_gpu->num_registers_per_core();
+   unsigned int max_threads_per_SM = reg_per_SM / reg_usage;
+   max_threads_per_SM = gs_min2(max_threads_per_SM, m_gpu->threads_per_core());
+   unsigned int min_threads_per_block = max_threads_per_SM / m_gpu->max_cta_per_core();
+   for( threads_per_block = min_threads_per_block; threads_per_block <= max_threads_per_SM; threads_per_block++ )
+      if( threads_per_block % 32 == 0 ) 
+         break;
+   // kernel size: enough blocks to fill the GPU with half of the concurrent kernel slots, to hide offchip metadata access latency
+   unsigned int max_con_kernels = m_gpu->get_config().get_max_concurrent_kernel() / 2;
+   unsigned int num_shaders = m_gpu->get_config().num_shader();
+   threads_per_kernel = ((num_shaders * (max_threads_per_SM / threads_per_block) + max_con_kernels) / max_con_kernels) * threads_per_block;
+   DEV_RUNTIME_REPORT("DCC: child kernel properties -- reg/thread " << reg_usage << ", max_thread/SM " << max_threads_per_SM << ", optimal_block_size " << threads_per_block << ", optimal_kernel_size " << threads_per_kernel);
+}
+
+bool dcc_threshold_policy::should_consolidate( const dcc_kernel_distributor_t &head, int &target_size )
+{
+   unsigned global_optimal_kernel_size = head.optimal_kernel_size;
+   if( !g_child_aware_smk_scheduling && head.optimal_kernel_size < potential_child_threads / available_tdq_slot )
+      global_optimal_kernel_size = potential_child_threads / available_tdq_slot;
+   if( pending_child_threads < global_optimal_kernel_size ) return false;
+   target_size = (pending_child_threads / head.optimal_block_size) * head.optimal_block_size;
+   return true;
+}
+
+bool dcc_timeout_policy::should_consolidate( const dcc_kernel_distributor_t &head, int &target_size )
+{
+   if( dcc_threshold_policy::should_consolidate(head, target_size) ) return true;
+   if( gpu_sim_cycle + gpu_tot_sim_cycle - head.kernel_grid->launch_cycle <= g_dcc_timeout_threshold ) return false;
+   if( pending_child_threads >= head.optimal_block_size ) target_size = (pending_child_threads / head.optimal_block_size) * head.optimal_block_size;
+   else target_size = -1;
+   return true;
+}
+
+bool dcc_occupancy_policy::should_consolidate( const dcc_kernel_distributor_t &head, int &target_size )
+{
+   unsigned free_slots = m_gpu->free_thread_slots();
+   if( free_slots < head.optimal_block_size || pending_child_threads < head.optimal_block_size ) return false;
+   target_size = (gs_min2(free_slots, pending_child_threads) / head.optimal_block_size) * head.optimal_block_size;
+   return true;
+}
+
+bool dcc_warp_policy::should_consolidate( const dcc_kernel_distributor_t &head, int &target_size )
+{
+   unsigned warp_size = m_gpu->wrp_size();
+   if( pending_child_threads < warp_size ) return false;
+   target_size = (pending_child_threads / warp_size) * warp_size;
+   return true;
+}
+
+dcc_consolidation_policy *dcc_get_consolidation_policy()
+{
+   static dcc_consolidation_policy *policy = NULL;
+   if( policy == NULL ){
+      extern gpgpu_sim *g_the_gpu;
+      std::string policy_config = g_dcc_consolidation_policy ? g_dcc_consolidation_policy : "threshold";
+      if( policy_config == "threshold" ) policy = new dcc_threshold_policy(g_the_gpu);
+      else if( policy_config == "timeout" ) policy = new dcc_timeout_policy(g_the_gpu);
+      else if( policy_config == "occupancy" ) policy = new dcc_occupancy_policy(g_the_gpu);
+      else if( policy_config == "warp" ) policy = new dcc_warp_policy(g_the_gpu);
+      else {
+         printf("GPGPU-Sim DKC: unknown consolidation policy \"%s\" (valid policies: threshold, timeout, occupancy, warp)\n", policy_config.c_str());
+         abort();
+      }
+      printf("GPGPU-Sim DKC: using the %s consolidation policy\n", policy->name());
+   }
+   return policy;
+}
+
 bool compare_dcc_kd_entry(const dcc_kernel_distributor_t &a, const dcc_kernel_distributor_t &b)
 {
    return (a.thread_count > b.thread_count);
@@ -378,28 +817,21 @@ void gpgpusim_cuda_getParameterBufferV2(const ptx_instruction * pI, ptx_thread_i
       g_total_child_threads += total_thread_count;
       potential_child_threads += total_thread_count;
 
-      // compute optimal block size for child kernel 
-      // It's an inefficient implementation since it only needs to be done once per child-kernel
-      unsigned int reg_usage = ptx_kernel_nregs(child_kernel_entry);
-      unsigned int reg_per_SM = thread->get_gpu()->num_registers_per_core();
-      unsigned int max_threads_per_SM = reg_per_SM / reg_usage;
-      max_threads_per_SM = gs_min2(max_threads_per_SM, thread->get_gpu()->threads_per_core());
-      unsigned int min_threads_per_block = max_threads_per_SM / thread->get_gpu()->max_cta_per_core();
-      unsigned int optimal_threads_per_block;
-      for( optimal_threads_per_block = min_threads_per_block; optimal_threads_per_block <= max_threads_per_SM; optimal_threads_per_block++ )
-         if( optimal_threads_per_block % 32 == 0 ) 
-            break;
+      // block and kernel size of the consolidated child kernels are chosen by the consolidation policy,
+      // once per child function and shader configuration
+      unsigned int optimal_threads_per_block, optimal_threads_per_kernel;
+      unsigned int config_epoch = thread->get_gpu()->getShaderCoreConfig()->gpgpu_occupancy_epoch;
+      if( !child_kernel_entry->get_dcc_launch_shape(config_epoch, optimal_threads_per_block, optimal_threads_per_kernel) ){
+         dcc_get_consolidation_policy()->launch_shape(child_kernel_entry, optimal_threads_per_block, optimal_threads_per_kernel);
+         child_kernel_entry->set_dcc_launch_shape(config_epoch, optimal_threads_per_block, optimal_threads_per_kernel);
+      }
       grid_dim.x = (total_thread_count + optimal_threads_per_block - 1) / optimal_threads_per_block;
       block_dim.x = optimal_threads_per_block;
       grid_dim.y = grid_dim.z = block_dim.y = block_dim.z = 1;
-      // compute optimal threads per kernel
-      unsigned int max_con_kernels = thread->get_gpu()->get_config().get_max_concurrent_kernel() / 2; //increaser kernel-level parallelism to hide offchip metadata access latency
-      unsigned int num_shaders = thread->get_gpu()->get_config().num_shader();
-      unsigned int optimal_threads_per_kernel = ((num_shaders * (max_threads_per_SM / optimal_threads_per_block) + max_con_kernels) / max_con_kernels) * optimal_threads_per_block ;
       /* *** 161213 overwrite opt_child_sz_offchip */
       if( opt_child_sz_offchip[g_app_name] != optimal_threads_per_kernel ) opt_child_sz_offchip[g_app_name] = optimal_threads_per_kernel;
 
-      DEV_RUNTIME_REPORT("DCC: child kernel properties -- #thread " << total_thread_count << ", reg/thread " << reg_usage << ", max_thread/SM " << max_threads_per_SM << ", optimal_block_size " << optimal_threads_per_block << ", optimal_kernel_size " << optimal_threads_per_kernel);
+      DEV_RUNTIME_REPORT("DCC: child kernel #thread " << total_thread_count);
 
       // pre-allocate child kernel entry and link it with parent kernel
       kernel_info_t * device_grid = new kernel_info_t(grid_dim, block_dim, child_kernel_entry); 
@@ -407,8 +839,7 @@ void gpgpusim_cuda_getParameterBufferV2(const ptx_instruction * pI, ptx_thread_i
       device_grid->set_param_mem_base((addr_t)tmp);
       device_grid->launch_cycle = gpu_sim_cycle + gpu_tot_sim_cycle;
       device_grid->is_child = true;
-      device_grid->m_param_mem_map[total_thread_count] = device_grid->get_param_memory(-1); //Po-Han DCC: setting to the kernel paramenter map
-      device_grid->m_param_mem_base_map[total_thread_count] = device_grid->get_param_memory_base(-1);
+      device_grid->set_param_segment(total_thread_count, device_grid->get_param_memory(-1), device_grid->get_param_memory_base(-1)); //Po-Han DCC: setting to the kernel paramenter map
       kernel_info_t & parent_grid = thread->get_kernel();
       device_grid->add_parent(&parent_grid, thread);  
       DEV_RUNTIME_REPORT("DCC: preallocate child kernel at kernel distributor by " << parent_grid.name() << ", cta (" <<
@@ -431,7 +862,8 @@ void gpgpusim_cuda_getParameterBufferV2(const ptx_instruction * pI, ptx_thread_i
 #endif
       // initialize the kernel distributor entry
       dcc_kernel_distributor_t distributor_entry(device_grid, total_thread_count, optimal_threads_per_block, optimal_threads_per_kernel, param_buffer, thread->get_agg_group_id(), thread->get_ctaid());
-      g_cuda_dcc_kernel_distributor.push_back(distributor_entry);
+      distributor_entry.parent_block_idx = thread->get_block_idx();
+      dcc_kd_insert(distributor_entry);
       DEV_RUNTIME_REPORT("DCC: kernel distributor with size " << g_cuda_dcc_kernel_distributor.size());
    }
 
@@ -465,359 +897,42 @@ bool merge_two_kernel_distributor_entry(dcc_kernel_distributor_t *kd_entry_1, dc
    std::map<unsigned int, addr_t>::iterator it_base;
    std::map<unsigned int, int>::iterator it_kqentry;
    unsigned int total_thread_1, total_thread_2;
-   int offset_a_1, offset_a_2, offset_b_1, offset_b_2;
+   int offset_a_1, offset_a_2;
    unsigned int total_thread_sum, total_thread_offset;
    unsigned int kernel_param_size;
-   int new_offset_a_2, new_offset_b_2;
+   int new_offset_a_2;
    unsigned int num_blocks, thread_per_block;
    unsigned int stride_1, stride_2;
    dim3 gDim;
    unsigned parent_block_idx_1, parent_block_idx_2;
-   size_t found1, found2;
 
    total_thread_1 = kd_entry_1->thread_count;
    total_thread_2 = kd_entry_2->thread_count;
 
    remaining = false;
-   switch(g_app_name){
-   case BFS:
-      //old [offset_a (4B), total_thread (4B), base_a (8B), base_b (8B), offset_b (4B)]
-      //new [offset_a (4B), total_thread (4B), offset_b (4B), base_a (8B), base_b (8B)]
-      mspace1->read((size_t) 0, 4, &offset_a_1);
-      mspace2->read((size_t) 0, 4, &offset_a_2);
-      assert( kd_entry_1->offset_base == offset_a_1);
-      assert( kd_entry_2->offset_base == offset_a_2);
-
-      if( offset_a_1 + total_thread_1 == offset_a_2 ){
-         DEV_RUNTIME_REPORT("DCC: BFS continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-         continous_offset = true;
-      } 
-      total_thread_offset = 4;
-      kernel_param_size = 28;
-      break;
-   case MST:
-      found1 = kd_entry_1->kernel_grid->name().find(mst_k1);
-      found2 = kd_entry_1->kernel_grid->name().find(mst_k2);
-      mspace1->read((size_t)0, 4, &offset_a_1);
-      mspace2->read((size_t)0, 4, &offset_a_2);
-      assert( kd_entry_1->offset_base == offset_a_1);
-      assert( kd_entry_2->offset_base == offset_a_2);
-      
-#if 0
-      parent_block_idx_1 = kd_entry_1->kernel_grid->m_parent_threads.front()->get_block_idx();
-      parent_block_idx_2 = kd_entry_2->kernel_grid->m_parent_threads.front()->get_block_idx();
-      if(parent_block_idx_1 != parent_block_idx_2){
-         return false;
-      }
-#endif
-      if(found1 != std::string::npos){ //kernel find1
-         //find1: [offset (4B), total_thread (4B), var (4Bx2), base (104B, 32B, 8B)]
-         if( offset_a_1 + total_thread_1 == offset_a_2 ){
-            DEV_RUNTIME_REPORT("DCC: MST-" << mst_k1 << " continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-            continous_offset = true;
-         }
-         total_thread_offset = 4;
-         kernel_param_size = 160;
-      }else if(found2 != std::string::npos){ //kernel find2
-         //find2: [offset (4B), total_thread (4B), var (4Bx2), base (104B, 32B, 8Bx2)]
-         if( offset_a_1 + total_thread_1 == offset_a_2 ){
-            DEV_RUNTIME_REPORT("DCC: MST-" << mst_k2 << " continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-            continous_offset = true;
-         }
-         total_thread_offset = 4;
-         kernel_param_size = 168;
-      }else{
-         DEV_RUNTIME_REPORT("DCC: unsupported minimum spanning tree child kernel name");
-         assert(0);
-      }
-      break;
-#if 0
-   case AMR:
-      //[total_thread (4B), base_a (8B), base_b (8B), var_a (F4B), const_a (4B), const_b (4B), const_c (F4B), offset (4B), var_b (4B), const (8B)]
-      mspace1->read((size_t)40, 4, &offset_a_1);
-      mspace2->read((size_t)40, 4, &offset_a_2);
-      assert( kd_entry_1->offset_base == offset_a_1);
-      assert( kd_entry_2->offset_base == offset_a_2);
-
-      if( offset_a_1 + total_thread_1 == offset_a_2 ){
-         DEV_RUNTIME_REPORT("DCC: AMR continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-         continous_offset = true;
-      }
-      total_thread_offset = 0;
-      kernel_param_size = 56;
-      break;
-#endif
-   case JOIN:
-      //old [base_a (8B), base_b (8B), offset_a (4B), total_thread (4B), offset_b (4B), var (4B)]
-      //new [offset_a (4B), total_thread (4B), offset_b (4B), var (4B), base_a~b (8Bx2)]
-      mspace1->read((size_t)0/*16*/, 4, &offset_a_1);
-      mspace2->read((size_t)0/*16*/, 4, &offset_a_2);
-      assert( kd_entry_1->offset_base == offset_a_1);
-      if( kd_entry_2->offset_base != offset_a_2 ){
-	 printf("Kernel %d: offset_base %d offset_mspace %d\n", kd_entry_2->kernel_grid->get_uid(), kd_entry_2->offset_base, offset_a_2);
-	 fflush(stdout);
-      }
-      assert( kd_entry_2->offset_base == offset_a_2);
-
-      if( offset_a_1 + total_thread_1 == offset_a_2 ){
-         DEV_RUNTIME_REPORT("DCC: JOIN continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-         continous_offset = true;
-      }
-      total_thread_offset = 4/*20*/;
-      kernel_param_size = 32;
-      break;
-   case SSSP:
-      //old [offset (4B), total_thread (4B), var (4B), base_a~d (8Bx4), const_a (8B), const_b (4B)]
-      //new [offset (4B), total_thread (4B), var (4B), base_a~d (8Bx4), const_a (8B), const_b (4B)]
-      mspace1->read((size_t) 0, 4, &offset_a_1);
-      mspace2->read((size_t) 0, 4, &offset_a_2);
-      assert( kd_entry_1->offset_base == offset_a_1);
-      assert( kd_entry_2->offset_base == offset_a_2);
-
-      if( offset_a_1 + total_thread_1 == offset_a_2 ){
-         DEV_RUNTIME_REPORT("DCC: SSSP continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-         continous_offset = true;
-      }
-      total_thread_offset = 4;
-      kernel_param_size = 60;
-      break;
-   case COLOR:
-      //old [offset (4B), total_thread (4B), base_a~d (8Bx3), var (8B)]
-      //new [offset (4B), total_thread (4B), var (8B), base_a~d (8Bx3)]
-      mspace1->read((size_t) 0, 4, &offset_a_1);
-      mspace2->read((size_t) 0, 4, &offset_a_2);
-      assert( kd_entry_1->offset_base == offset_a_1);
-      assert( kd_entry_2->offset_base == offset_a_2);
-
-#if 0
-      parent_block_idx_1 = kd_entry_1->kernel_grid->m_parent_threads.front()->get_block_idx();
-      parent_block_idx_2 = kd_entry_2->kernel_grid->m_parent_threads.front()->get_block_idx();
-      if(parent_block_idx_1 != parent_block_idx_2){
-         return false;
-      }
-#endif
-      if( offset_a_1 + total_thread_1 == offset_a_2 ){
-         DEV_RUNTIME_REPORT("DCC: COLOR continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-         continous_offset = true;
-      }
-      total_thread_offset = 4;
-      kernel_param_size = 48;
-      break;
-   case MIS:
-      found1 = kd_entry_1->kernel_grid->name().find(mis_k1);
-      found2 = kd_entry_1->kernel_grid->name().find(mis_k2);
-      mspace1->read((size_t) 0, 4, &offset_a_1);
-      mspace2->read((size_t) 0, 4, &offset_a_2);
-      assert( kd_entry_1->offset_base == offset_a_1);
-      assert( kd_entry_2->offset_base == offset_a_2);
-#if 0
-      parent_block_idx_1 = kd_entry_1->kernel_grid->m_parent_threads.front()->get_block_idx();
-      parent_block_idx_2 = kd_entry_2->kernel_grid->m_parent_threads.front()->get_block_idx();
-      if(parent_block_idx_1 != parent_block_idx_2){
-         return false;
-      }
-#endif
-      if( offset_a_1 + total_thread_1 == offset_a_2 ){
-         if(found1 != std::string::npos){ //kernel mis1
-	    //[offset (4B), total_thread (4B), var (8B), base_a~c (8Bx3)]
-	    DEV_RUNTIME_REPORT("DCC: MIS1 continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-         } else if(found2 != std::string::npos){ //kernel mis2
-	    //[offset (4B), total_thread (4B), base_a~c (8Bx3)]
-	    DEV_RUNTIME_REPORT("DCC: MIS2 continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-         }
-         continous_offset = true;
-      }
-      total_thread_offset = 4;
-      if(found1 != std::string::npos){ //kernel mis1
-         kernel_param_size = 40;
-      } else if(found2 != std::string::npos){ //kernel mis2
-         kernel_param_size = 32;
-      }
-      break;
-   case PAGERANK:
-      found1 = kd_entry_1->kernel_grid->name().find(pr_k1);
-      found2 = kd_entry_1->kernel_grid->name().find(pr_k2);
-      //[offset (4B), total_thread (4B), var (8B), base_a~c (8Bx3)]
-      mspace1->read((size_t) 0, 4, &offset_a_1);
-      mspace2->read((size_t) 0, 4, &offset_a_2);
-      assert( kd_entry_1->offset_base == offset_a_1);
-      assert( kd_entry_2->offset_base == offset_a_2);
-
-//      parent_block_idx_1 = kd_entry_1->kernel_grid->m_parent_threads.front()->get_block_idx();
-//      parent_block_idx_2 = kd_entry_2->kernel_grid->m_parent_threads.front()->get_block_idx();
-      
-      if(found1 != std::string::npos){ //kernel inicsr
-         //[offset (4B), total_thread (4B), base_a~c (8Bx3)]
-         if( offset_a_1 + total_thread_1 == offset_a_2 ){
-            DEV_RUNTIME_REPORT("DCC: PAGERANK-" << pr_k1 << " continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-            continous_offset = true;
-         }
-         total_thread_offset = 4;
-         kernel_param_size = 32;
-      }else if(found2 != std::string::npos){ //kernel spmv_csr_scalar
-         //[offset (4B), total_thread (4B), var (8B), base_a~c (8Bx3)]
-         if( offset_a_1 + total_thread_1 == offset_a_2 ){
-            DEV_RUNTIME_REPORT("DCC: PAGERANK-" << pr_k2 << " continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-            continous_offset = true;
-         }
-         total_thread_offset = 4;
-         kernel_param_size = 40;
-      }else{
-         DEV_RUNTIME_REPORT("DCC: unsupported pagerank child kernel name");
-         assert(0);
-      }
-      break;
-   case KMEANS:
-      //old [total_thread (4B), offset_2 (4B), stride (4B), base_a~b (8Bx2), offset_1 (4B), var (8B)]
-      //new [total_thread (4B), offset_2 (4B), stride (4B), offset_1 (4B), var (8B), base_a~b (8Bx2)]
-      mspace1->read((size_t)12, 4, &offset_a_1);
-      mspace2->read((size_t)12, 4, &offset_a_2);
-//      mspace1->read((size_t) 0, 4, &total_thread_1);
-//      mspace2->read((size_t) 0, 4, &total_thread_2);
-//      mspace1->read((size_t) 4, 4, &offset_b_1);
-//      mspace2->read((size_t) 4, 4, &offset_b_2);
-//      mspace1->read((size_t) 8, 4, &stride_1);
-//      mspace2->read((size_t) 8, 4, &stride_2);
-
-      assert( kd_entry_1->offset_base == offset_a_1);
-      assert( kd_entry_2->offset_base == offset_a_2);
-//      assert( kd_entry_1->thread_count == total_thread_1 );
-//      assert( kd_entry_2->thread_count == total_thread_2 );
-//      assert( stride_1 == stride_2 );
+   const dcc_param_layout_t *layout = dcc_get_param_layout(kd_entry_1->kernel_grid->entry());
+   mspace1->read((size_t)layout->offset_pos, 4, &offset_a_1);
+   mspace2->read((size_t)layout->offset_pos, 4, &offset_a_2);
+   assert( kd_entry_1->offset_base == offset_a_1);
+   if( kd_entry_2->offset_base != offset_a_2 ){
+      printf("Kernel %d: offset_base %d offset_mspace %d\n", kd_entry_2->kernel_grid->get_uid(), kd_entry_2->offset_base, offset_a_2);
+      fflush(stdout);
+   }
+   assert( kd_entry_2->offset_base == offset_a_2);
 
-#if 0
-      parent_block_idx_1 = kd_entry_1->kernel_grid->m_parent_threads.front()->get_block_idx();
-      parent_block_idx_2 = kd_entry_2->kernel_grid->m_parent_threads.front()->get_block_idx();
-      if(parent_block_idx_1 != parent_block_idx_2){
-         return false;
-      }
-#endif
-      if( offset_a_1 + total_thread_1 == offset_a_2 ){
-         DEV_RUNTIME_REPORT("DCC: KMEANS continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-         continous_offset = true;
-      }
-      total_thread_offset = 0;
-      kernel_param_size = 40;
-      break;
-   case SP:
-      found1 = kd_entry_1->kernel_grid->name().find(sp_k1);
-      found2 = kd_entry_1->kernel_grid->name().find(sp_k2);
-      mspace1->read((size_t)0, 4, &offset_a_1);
-      mspace2->read((size_t)0, 4, &offset_a_2);
-      assert( kd_entry_1->offset_base == offset_a_1);
-      assert( kd_entry_2->offset_base == offset_a_2);
-      
-#if 0
+   if( layout->same_parent_block ){
       parent_block_idx_1 = kd_entry_1->kernel_grid->m_parent_threads.front()->get_block_idx();
       parent_block_idx_2 = kd_entry_2->kernel_grid->m_parent_threads.front()->get_block_idx();
       if(parent_block_idx_1 != parent_block_idx_2){
          return false;
       }
-#endif
-      if(found1 != std::string::npos){ //kernel update_bias
-         //update_bias: [offset (4B), total_thread (4B), var (8Bx3), base (48B, 48B, 64B)]
-         if( offset_a_1 + total_thread_1 == offset_a_2 ){
-            DEV_RUNTIME_REPORT("DCC: SP-" << sp_k1 << " continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-            continous_offset = true;
-         }
-         total_thread_offset = 4;
-         kernel_param_size = 192;
-      }else if(found2 != std::string::npos){ //kernel calc_pi_value
-         //calc_pi_value: [offset (4B), total_thread (4B), var (4Bx2, 8Bx3), base (48B, 48B, 64B)]
-         if( offset_a_1 + total_thread_1 == offset_a_2 ){
-            DEV_RUNTIME_REPORT("DCC: SP-" << sp_k2 << " continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-            continous_offset = true;
-         }
-         total_thread_offset = 4;
-         kernel_param_size = 208;
-      }else{
-         DEV_RUNTIME_REPORT("DCC: unsupported survey-propagation child kernel name");
-         assert(0);
-      }
-      break;
-#if 0
-   case BFS_RODINIA:
-      //[var (4B), total_thread (4B), offset (4B), base_a~d (8Bx4)]
-      mspace1->read((size_t) 8, 4, &offset_a_1);
-      mspace2->read((size_t) 8, 4, &offset_a_2);
-      assert( kd_entry_1->offset_base == offset_a_1);
-      assert( kd_entry_2->offset_base == offset_a_2);
-
-      if( offset_a_1 + total_thread_1 == offset_a_2 ){
-         //child kernel 2 can be catenated after child kernel 1
-         DEV_RUNTIME_REPORT("DCC: BFS_RODINIA continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-         continous_offset = true;
-      }
-      total_thread_offset = 4;
-      kernel_param_size = 44;
-      break;
-#endif
-   case BC:
-      found1 = kd_entry_1->kernel_grid->name().find(bc_k1);
-      found2 = kd_entry_1->kernel_grid->name().find(bc_k2);
-      //[offset (4B), total_thread (4B), base_a~d (8Bx4), var (4B), const (4B)]
-      mspace1->read((size_t) 0, 4, &offset_a_1);
-      mspace2->read((size_t) 0, 4, &offset_a_2);
-      assert( kd_entry_1->offset_base == offset_a_1);
-      assert( kd_entry_2->offset_base == offset_a_2);
-
-      if(found1 != std::string::npos){ //kernel bfs
-         kernel_param_size = 48;
-      } else if(found2 != std::string::npos){ //kernel backtrack
-	  parent_block_idx_1 = kd_entry_1->kernel_grid->m_parent_threads.front()->get_block_idx();
-	  parent_block_idx_2 = kd_entry_2->kernel_grid->m_parent_threads.front()->get_block_idx();
-	  if(parent_block_idx_1 != parent_block_idx_2){
-	      return false;
-	  }
-	  kernel_param_size = 48;
-      }
-      
-      if( offset_a_1 + total_thread_1 == offset_a_2 ){
-         if(found1 != std::string::npos){ //kernel bfs
-            DEV_RUNTIME_REPORT("DCC: BC-bfs continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-         } else if(found2 != std::string::npos){ //kernel backtrack
-            DEV_RUNTIME_REPORT("DCC: BC-backtrack continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-         }
-         continous_offset = true;
-      }
-      
-      total_thread_offset = 4;
-      break;
-   case SPMV:
-      //[offset (4B), total_thread (4B), var (8B), base_a~b (8Bx2)]
-      mspace1->read((size_t) 0, 4, &offset_a_1);
-      mspace2->read((size_t) 0, 4, &offset_a_2);
-      assert( kd_entry_1->offset_base == offset_a_1);
-      assert( kd_entry_2->offset_base == offset_a_2);
-
-      if( offset_a_1 + total_thread_1 == offset_a_2 ){
-         //child kernel 2 can be catenated after child kernel 1
-         DEV_RUNTIME_REPORT("DCC: SPMV continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-         continous_offset = true;
-      }
-      total_thread_offset = 4;
-      kernel_param_size = 32;
-      break;
-   case BL:
-      //[offset (4B), total_thread (4B), base_a~c (8Bx3)]
-      mspace1->read((size_t) 0, 4, &offset_a_1);
-      mspace2->read((size_t) 0, 4, &offset_a_2);
-      assert( kd_entry_1->offset_base == offset_a_1);
-      assert( kd_entry_2->offset_base == offset_a_2);
-
-      if( offset_a_1 + total_thread_1 == offset_a_2 ){
-         //child kernel 2 can be catenated after child kernel 1
-         DEV_RUNTIME_REPORT("DCC: BL continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
-         continous_offset = true;
-      }
-      total_thread_offset = 4;
-      kernel_param_size = 32;
-      break;
-   default:
-      DEV_RUNTIME_REPORT("Dynamic Child-thread Consolidation: unsupported application");
-      assert(0);
-      break;
    }
+   if( offset_a_1 + total_thread_1 == offset_a_2 ){
+      DEV_RUNTIME_REPORT("DCC: " << kd_entry_1->kernel_grid->name() << " continous -> child1 (" << offset_a_1 << ", " << total_thread_1 << ") child2 (" << offset_a_2 << ", " << total_thread_2 << ")");
+      continous_offset = true;
+   }
+   total_thread_offset = layout->total_thread_pos;
+   kernel_param_size = layout->param_size;
 
    if(target_size != -1 && total_thread_1 > target_size) return false; //enough thread for a child kernel, merge is unnecessary
 
@@ -832,7 +947,7 @@ bool merge_two_kernel_distributor_entry(dcc_kernel_distributor_t *kd_entry_1, dc
       // adjust thread count
       total_thread_sum = total_thread_1 + total_thread_2;
       if( (target_size != -1) && (total_thread_sum > target_size) ){
-	  if(g_app_name != MST && g_app_name != KMEANS && g_app_name != SP){
+	  if(layout->splittable){
 //         if (kd_entry_2->kernel_grid->m_param_mem_map.size() > 1) //if the latter kd entry is composed of more than 1 child kernel, find another one
 //            return false;
          remaining = true;
@@ -887,7 +1002,7 @@ bool merge_two_kernel_distributor_entry(dcc_kernel_distributor_t *kd_entry_1, dc
          if (!split){
             offset = it->first + total_thread_1;
             DEV_RUNTIME_REPORT("DCC pre-split: copy kernel param " << it->second << " old offset " << it->first << " new offset " << offset );
-            if( target_size != -1 && (g_app_name != MST && g_app_name != KMEANS && g_app_name != SP) ){
+            if( target_size != -1 && layout->splittable ){
                if(offset > target_size) { //boundary parameter buffer -> duplicate
                   boundary = true;
                   for(unsigned n = 0; n < kernel_param_size; n += 4) {
@@ -908,8 +1023,7 @@ bool merge_two_kernel_distributor_entry(dcc_kernel_distributor_t *kd_entry_1, dc
             }
 //            DEV_RUNTIME_REPORT("DCC pre-split: copy kernel param " << it->second << " old offset " << it->first << " new offset " << offset );
             it->second->write((size_t)total_thread_offset, 4, &total_thread_sum, NULL, NULL);
-            kd_entry_1->kernel_grid->m_param_mem_map[offset] = it->second;
-	    kd_entry_1->kernel_grid->m_param_mem_base_map[offset] = it_base->second;
+            kd_entry_1->kernel_grid->set_param_segment(offset, it->second, it_base->second);
 	    kd_entry_1->kernel_grid->m_kernel_queue_entry_map[offset] = it_kqentry->second;
          } else { // splitted -> modifying parameter memory maps
             DEV_RUNTIME_REPORT("DCC post-split: copy kernel param " << it->second << " old offset " << it->first << " new offset " << (it->first-(total_thread_2 - remaining_count)) );
@@ -919,225 +1033,32 @@ bool merge_two_kernel_distributor_entry(dcc_kernel_distributor_t *kd_entry_1, dc
 	    new_kq_entry[it_kqentry->first-(total_thread_2-remaining_count)] = it_kqentry->second;
          }
 
-         switch(g_app_name){
-         case BFS:
-            it->second->read((size_t) 8/*24*/, 4, &offset_b_2);
-            it->second->read((size_t) 0, 4, &offset_a_2);
-            if(remaining && !split && boundary ){
-               new_offset_a_2 = offset_a_2 + total_thread_2 - remaining_count;
-               new_offset_b_2 = offset_b_2 + total_thread_2 - remaining_count;
-               new_mspace->write((size_t) 0, 4, &new_offset_a_2, NULL, NULL);
-               new_mspace->write((size_t) 8/*24*/, 4, &new_offset_b_2, NULL, NULL);
-
-//	       kd_entry_2->offset_base = new_offset_a_2;
-            }
-            if(!split){
-               offset_a_2 -= total_thread_1;
-               offset_b_2 -= total_thread_1;
-            } else {
-               offset_a_2 += (total_thread_2 - remaining_count);
-               offset_b_2 += (total_thread_2 - remaining_count);
-            }
-            it->second->write((size_t) 0, 4, &offset_a_2, NULL, NULL);
-            it->second->write((size_t) 8/*24*/, 4, &offset_b_2, NULL, NULL);
-            break;
-	case MST:
-	    assert(!remaining && !split && !boundary);
-	    it->second->read((size_t) 0, 4, &offset_a_2);
-	    offset_a_2 -= total_thread_1;
-	    it->second->write((size_t) 0, 4, &offset_a_2, NULL, NULL);
-	    break;
-#if 0
-         case AMR:
-            it->second->read((size_t)40, 4, &offset_a_2);
-            if(remaining && !split && boundary){
-               new_offset_a_2 = offset_a_2 + total_thread_2 - remaining_count;
-               new_mspace->write((size_t)40, 4, &new_offset_a_2, NULL, NULL);
-//	       kd_entry_2->offset_base = new_offset_a_2;
-            }
-            if(!split){
-               offset_a_2 -= total_thread_1;
-            }else{
-               offset_a_2 += (total_thread_2 - remaining_count);
-            }
-            it->second->write((size_t)40, 4, &offset_a_2, NULL, NULL);
-            break;
-#endif
-         case JOIN:
-//            mspace1->read((size_t)24, 4, &offset_b_1);
-            it->second->read((size_t) 8/*24*/, 4, &offset_b_2);
-            it->second->read((size_t) 0/*16*/, 4, &offset_a_2);
+         // rebase the thread offsets of the child onto the merged kernel
+         if( !layout->splittable ) 
+            assert(!remaining && !split && !boundary);
+         for( unsigned f = 0; f < layout->shift_pos.size(); f++ ){
+            size_t pos = layout->shift_pos[f];
+            it->second->read(pos, 4, &offset_a_2);
             if(remaining && !split && boundary){
                new_offset_a_2 = offset_a_2 + total_thread_2 - remaining_count;
-               new_offset_b_2 = offset_b_2 + total_thread_2 - remaining_count;
-               new_mspace->write((size_t) 0/*16*/, 4, &new_offset_a_2, NULL, NULL);
-               new_mspace->write((size_t) 8/*24*/, 4, &new_offset_b_2, NULL, NULL);
-//	       kd_entry_2->offset_base = new_offset_a_2;
+               new_mspace->write(pos, 4, &new_offset_a_2, NULL, NULL);
             }
             if(!split){
                offset_a_2 -= total_thread_1;
-               offset_b_2 -= total_thread_1;
             } else {
                offset_a_2 += (total_thread_2 - remaining_count);
-               offset_b_2 += (total_thread_2 - remaining_count);
-            }
-            it->second->write((size_t) 0/*16*/, 4, &offset_a_2, NULL, NULL);
-            it->second->write((size_t) 8/*24*/, 4, &offset_b_2, NULL, NULL);
-            break;
-         case SSSP:
-            it->second->read((size_t) 0, 4, &offset_a_2);
-            if(remaining && !split && boundary){
-               new_offset_a_2 = offset_a_2 + total_thread_2 - remaining_count;
-               new_mspace->write((size_t) 0, 4, &new_offset_a_2, NULL, NULL);
-//	       kd_entry_2->offset_base = new_offset_a_2;
-            }
-            if(!split){
-               offset_a_2 -= total_thread_1;
-            }else{
-               offset_a_2 += (total_thread_2 - remaining_count);
             }
-            it->second->write((size_t) 0, 4, &offset_a_2, NULL, NULL);
-            break;
-         case COLOR:
-            it->second->read((size_t) 0, 4, &offset_a_2);
-            if(remaining && !split && boundary){
-               new_offset_a_2 = offset_a_2 + total_thread_2 - remaining_count;
-               new_mspace->write((size_t) 0, 4, &new_offset_a_2, NULL, NULL);
-//	       kd_entry_2->offset_base = new_offset_a_2;
-            }
-            if(!split){
-               offset_a_2 -= total_thread_1;
-            }else{
-               offset_a_2 += (total_thread_2 - remaining_count);
-            }
-            it->second->write((size_t) 0, 4, &offset_a_2, NULL, NULL);
-            break;
-         case MIS:
-//            if(found1 != std::string::npos) assert(!remaining && !split && !boundary);
-            it->second->read((size_t) 0, 4, &offset_a_2);
-//            if(found2 != std::string::npos){
-	    if(remaining && !split && boundary){
-	       new_offset_a_2 = offset_a_2 + total_thread_2 - remaining_count;
-	       new_mspace->write((size_t) 0, 4, &new_offset_a_2, NULL, NULL);
-//	       kd_entry_2->offset_base = new_offset_a_2;
-	    }
-	    if(!split){
-	       offset_a_2 -= total_thread_1;
-	    }else{
-	       offset_a_2 += (total_thread_2 - remaining_count);
-	    }
-	    //            } else {
-	    //               offset_b_1 -= total_thread_1;
-	    //            }
-	    it->second->write((size_t) 0, 4, &offset_a_2, NULL, NULL);
-	    break;
-	case PAGERANK:
-	    /*if(found2 != std::string::npos) assert(!remaining && !split && !boundary); */
-	    it->second->read((size_t) 0, 4, &offset_a_2);
-	    //            if(found1 != std::string::npos){
-	    if(remaining && !split && boundary){
-	       new_offset_a_2 = offset_a_2 + total_thread_2 - remaining_count;
-	       new_mspace->write((size_t) 0, 4, &new_offset_a_2, NULL, NULL);
-//	       kd_entry_2->offset_base = new_offset_a_2;
-	    }
-	    if(!split){
-	       offset_a_2 -= total_thread_1;
-	    }else{
-	       offset_a_2 += (total_thread_2 - remaining_count);
-	    }
-	    //            } else {
-	    //               offset_b_1 -= total_thread_1;
-	    //            }
-	    it->second->write((size_t) 0, 4, &offset_a_2, NULL, NULL);
-	    break;
-	case KMEANS:
-	    assert(!remaining && !split && !boundary);
-	    mspace1->read((size_t) 8, 4, &stride_1);
-	    it->second->read((size_t) 8, 4, &stride_2);
-	    assert(stride_1 == stride_2);
-	    it->second->read((size_t)12, 4, &offset_a_2);
-	    offset_a_2 -= total_thread_1;
-	    it->second->write((size_t)12, 4, &offset_a_2, NULL, NULL);
-	    it->second->read((size_t) 4, 4, &offset_b_2);
-	    offset_b_2 -= total_thread_1 * stride_1;
-	    it->second->write((size_t) 4, 4, &offset_b_2, NULL, NULL);
-	    break;
-	case SP:
-	    assert(!remaining && !split && !boundary);
-	    it->second->read((size_t) 0, 4, &offset_a_2);
-	    offset_a_2 -= total_thread_1;
-	    it->second->write((size_t) 0, 4, &offset_a_2, NULL, NULL);
-	    break;
-#if 0
-	case BFS_RODINIA:
-	    it->second->read((size_t) 8, 4, &offset_a_2);
-	    if(remaining && !split && boundary){
-	       new_offset_a_2 = offset_a_2 + total_thread_2 - remaining_count;
-	       new_mspace->write((size_t) 8, 4, &new_offset_a_2, NULL, NULL);
-//	       kd_entry_2->offset_base = new_offset_a_2;
-	    }
-	    if(!split){
-	       offset_a_2 -= total_thread_1;
-	    }else{
-	       offset_a_2 += (total_thread_2 - remaining_count);
-	    }
-	    it->second->write((size_t) 8, 4, &offset_a_2, NULL, NULL);
-	    break;
-#endif
-	case BC:
-	    if(found2 != std::string::npos){ //kernel backtrack
-		assert(!remaining && !split && !boundary);
-		it->second->read((size_t) 0, 4, &offset_a_2);
-		offset_a_2 -= total_thread_1;
-		it->second->write((size_t) 0, 4, &offset_a_2, NULL, NULL);
-	    } else if (found1 != std::string::npos){ //kernel bfs
-		it->second->read((size_t) 0, 4, &offset_a_2);
-		if(remaining && !split && boundary){
-		    new_offset_a_2 = offset_a_2 + total_thread_2 - remaining_count;
-		    new_mspace->write((size_t) 0, 4, &new_offset_a_2, NULL, NULL);
-		    //	       kd_entry_2->offset_base = new_offset_a_2;
-		}
-		if(!split){
-		    offset_a_2 -= total_thread_1;
-		}else{
-		    offset_a_2 += (total_thread_2 - remaining_count);
-		}
-		it->second->write((size_t) 0, 4, &offset_a_2, NULL, NULL);
-	    }
-	    break;
-         case SPMV:
-            it->second->read((size_t) 0, 4, &offset_a_2);
-            if(remaining && !split && boundary){
-               new_offset_a_2 = offset_a_2 + total_thread_2 - remaining_count;
-               new_mspace->write((size_t) 0, 4, &new_offset_a_2, NULL, NULL);
-//	       kd_entry_2->offset_base = new_offset_a_2;
-            }
-            if(!split){
-               offset_a_2 -= total_thread_1;
-            }else{
-               offset_a_2 += (total_thread_2 - remaining_count);
-            }
-            it->second->write((size_t) 0, 4, &offset_a_2, NULL, NULL);
-	    break;
-         case BL:
-            it->second->read((size_t) 0, 4, &offset_a_2);
-            if(remaining && !split && boundary){
-               new_offset_a_2 = offset_a_2 + total_thread_2 - remaining_count;
-               new_mspace->write((size_t) 0, 4, &new_offset_a_2, NULL, NULL);
-//	       kd_entry_2->offset_base = new_offset_a_2;
-            }
-            if(!split){
-               offset_a_2 -= total_thread_1;
-            }else{
-               offset_a_2 += (total_thread_2 - remaining_count);
-            }
-            it->second->write((size_t) 0, 4, &offset_a_2, NULL, NULL);
-	    break;
-	 default:
-	    DEV_RUNTIME_REPORT("Dynamic Child-thread Consolidation: unsupported application");
-	    assert(0);
-	    break;
-	 }
+            it->second->write(pos, 4, &offset_a_2, NULL, NULL);
+         }
+         if( layout->strided_pos != -1 ){
+            mspace1->read((size_t)layout->stride_pos, 4, &stride_1);
+            it->second->read((size_t)layout->stride_pos, 4, &stride_2);
+            assert(stride_1 == stride_2);
+            int offset_b;
+            it->second->read((size_t)layout->strided_pos, 4, &offset_b);
+            offset_b -= total_thread_1 * stride_1;
+            it->second->write((size_t)layout->strided_pos, 4, &offset_b, NULL, NULL);
+         }
 
 	 if(!split){
 	    //            DEV_RUNTIME_REPORT("DCC pre-split: copy kernel param " << it->second << " old offset " << it->first << " new offset " << offset );
@@ -1152,13 +1073,11 @@ bool merge_two_kernel_distributor_entry(dcc_kernel_distributor_t *kd_entry_1, dc
 
       if(split && remaining){
 	 //new_map[split_size] = new_mspace;
-	 kd_entry_2->kernel_grid->m_param_mem_map.clear();
-	 kd_entry_2->kernel_grid->m_param_mem_base_map.clear();
+	 kd_entry_2->kernel_grid->clear_param_segments();
 	 kd_entry_2->kernel_grid->m_kernel_queue_entry_map.clear();
 	 kd_entry_2->onchip_metadata = 0;
 	 for(it=new_map.begin(), it_base=new_map_base.begin(), it_kqentry=new_kq_entry.begin(); it!=new_map.end(); it++, it_base++, it_kqentry++){
-	    kd_entry_2->kernel_grid->m_param_mem_map[it->first] = it->second;
-	    kd_entry_2->kernel_grid->m_param_mem_base_map[it_base->first] = it_base->second;
+	    kd_entry_2->kernel_grid->set_param_segment(it->first, it->second, it_base->second);
 	    kd_entry_2->kernel_grid->m_kernel_queue_entry_map[it_kqentry->first] = it_kqentry->second;
 	    if(it_kqentry->second != -1) kd_entry_2->onchip_metadata++;
 	    DEV_RUNTIME_REPORT("DCC post-split: copy param mem map at offset " << it->first << " back to kernel " << kd_entry_2->kernel_grid->get_uid());
@@ -1194,7 +1113,7 @@ bool merge_two_kernel_distributor_entry(dcc_kernel_distributor_t *kd_entry_1, dc
 	 unsigned int offset;
 	 it = kd_entry_2->kernel_grid->m_param_mem_map.begin();
 	 mspace2 = it->second;
-	 mspace2->read((size_t)per_kernel_offset[g_app_name], 4, &offset);
+	 mspace2->read((size_t)layout->offset_pos, 4, &offset);
 	 kd_entry_2->offset_base = offset;
 	 DEV_RUNTIME_REPORT("DCC: threads remained after consolidation --> re-read offset of kernel " << kd_entry_2->kernel_grid->get_uid() << " as " << offset);
          // reset the parameter map of the second kd entry and linked it with new memory space
@@ -1223,6 +1142,7 @@ void gpgpusim_cuda_launchDeviceV2(const ptx_instruction * pI, ptx_thread_info *
    assert( n_args == 2 );
 
    kernel_info_t * device_grid = NULL;
+   agg_block_group_t * warp_batch = NULL;
    kernel_info_t * temp_grid = NULL;
    function_info * device_kernel_entry = NULL;
    void * parameter_buffer;
@@ -1269,38 +1189,34 @@ void gpgpusim_cuda_launchDeviceV2(const ptx_instruction * pI, ptx_thread_info *
              * 1) Change the valid bit of the corresponding kernel distributor entry so that it is open for merge
              * 2) Copy kernel parameters to corresponding places
              */
-   //         std::list<dcc_kernel_distributor_t>::iterator kd_entry;
-            unsigned int i;
-            for(kd_entry = g_cuda_dcc_kernel_distributor.begin(), i = 0;
-              kd_entry != g_cuda_dcc_kernel_distributor.end();
-              kd_entry++, i++){
-               if( kd_entry->parameter_buffer == parameter_buffer ){
-                  kd_entry->valid = true;
-		  kd_entry->kernel_queue_entry_id = allocate_kernel_queue_entry();
-		  if (kd_entry->kernel_queue_entry_id == -1){
-		      kd_entry->onchip_metadata = 0;
-		      total_num_offchip_metadata++;	//record the number of metadata that are stored in global memory
-		      num_offchip_metadata++;
-		      if ( total_num_offchip_metadata > maximum_num_offchip_metadata ) maximum_num_offchip_metadata = total_num_offchip_metadata;
-		      printf("DKC: store an off-chip kernel metadata, %llu now %llu totally\n", total_num_offchip_metadata, num_offchip_metadata);
-		  } else {
-		      kd_entry->onchip_metadata = 1;
-		  }
-		  printf("TDQ, %llu, %d, %d, A\n", gpu_sim_cycle+gpu_tot_sim_cycle, kd_entry->kernel_queue_entry_id, g_kernel_queue_entry_used );
-		  kd_entry->kernel_grid->m_kernel_queue_entry_map[kd_entry->thread_count] = kd_entry->kernel_queue_entry_id;
-                  device_grid = kd_entry->kernel_grid; //get kernel descriptor
-//                  device_grid->m_launch_latency += 7200; //simulate create stream latency
-                  device_kernel_param_mem = kd_entry->kernel_grid->get_param_memory(-1); //get paramenter buffer
-                  pending_child_threads += kd_entry->thread_count; //record pending child threads
-                  k_dis = &(*kd_entry);
-		  k_dis->agg_group_id = thread->get_agg_group_id();
-		  k_dis->ctaid = thread->get_ctaid();
-                  /* Parent-child dependency */
-                  thread->get_kernel().block_state[thread->get_block_idx()].thread.reset(thread->get_thread_idx());
-                  DEV_RUNTIME_REPORT("DCC: activate kernel metadata " << i << " at entry " << kd_entry->kernel_queue_entry_id << " with parameter buffer address " << parameter_buffer << ", kernel distributor now has " << pending_child_threads << " pending threads.");
-                  DEV_RUNTIME_REPORT("Reset block state for block " << thread->get_block_idx() << " thread " << thread->get_thread_idx());
-                  break;
+            std::map<void *, dcc_kd_iter_t>::iterator pb_it = g_dcc_kd_by_param_buffer.find(parameter_buffer);
+            if( pb_it != g_dcc_kd_by_param_buffer.end() ){
+               kd_entry = pb_it->second;
+               kd_entry->valid = true;
+               kd_entry->kernel_queue_entry_id = allocate_kernel_queue_entry();
+               if (kd_entry->kernel_queue_entry_id == -1){
+                   kd_entry->onchip_metadata = 0;
+                   total_num_offchip_metadata++;	//record the number of metadata that are stored in global memory
+                   num_offchip_metadata++;
+                   if ( total_num_offchip_metadata > maximum_num_offchip_metadata ) maximum_num_offchip_metadata = total_num_offchip_metadata;
+                   printf("DKC: store an off-chip kernel metadata, %llu now %llu totally\n", total_num_offchip_metadata, num_offchip_metadata);
+               } else {
+                   kd_entry->onchip_metadata = 1;
                }
+               printf("TDQ, %llu, %d, %d, A\n", gpu_sim_cycle+gpu_tot_sim_cycle, kd_entry->kernel_queue_entry_id, g_kernel_queue_entry_used );
+               kd_entry->kernel_grid->m_kernel_queue_entry_map[kd_entry->thread_count] = kd_entry->kernel_queue_entry_id;
+               device_grid = kd_entry->kernel_grid; //get kernel descriptor
+//                  device_grid->m_launch_latency += 7200; //simulate create stream latency
+               device_kernel_param_mem = kd_entry->kernel_grid->get_param_memory(-1); //get paramenter buffer
+               pending_child_threads += kd_entry->thread_count; //record pending child threads
+               k_dis = &(*kd_entry);
+               k_dis->agg_group_id = thread->get_agg_group_id();
+               k_dis->ctaid = thread->get_ctaid();
+               /* Parent-child dependency */
+               thread->get_kernel().block_state[thread->get_block_idx()].thread.reset(thread->get_thread_idx());
+               DEV_RUNTIME_REPORT("DCC: activate kernel metadata " << kd_entry->kd_seq << " at entry " << kd_entry->kernel_queue_entry_id << " with parameter buffer address " << parameter_buffer << ", kernel distributor now has " << pending_child_threads << " pending threads.");
+               DEV_RUNTIME_REPORT("Reset block state for block " << thread->get_block_idx() << " thread " << thread->get_thread_idx());
+               dcc_kd_activate(kd_entry);
             }
 
 #if 0
@@ -1340,8 +1256,21 @@ void gpgpusim_cuda_launchDeviceV2(const ptx_instruction * pI, ptx_thread_info *
          } else {
             //find if the same kernel has been launched before
             device_grid = find_launched_grid(device_kernel_entry, &thread->get_kernel(), thread->get_block_idx());
+            if(device_grid == NULL && g_cdp_warp_launch_batching && !g_agg_blocks_support)
+               warp_batch = join_warp_launch_batch(pI, thread, device_kernel_entry, config.block_dim);
 
-            if(device_grid == NULL) { //first time launch, as child kernel
+            if(warp_batch != NULL) { //batched with an earlier lane of this warp, no launch op of its own
+	       uintptr_t tmp = (uintptr_t)parameter_buffer;
+               device_grid = warp_batch->get_kernel();
+               device_kernel_param_mem = warp_batch->add_lane(config.grid_dim, (addr_t)tmp, thread);
+               DEV_RUNTIME_REPORT("warp launch batching: entry " << warp_batch->get_num_lanes() - 1 << 
+                 " of child kernel " << device_grid->get_uid() << ", cta (" << thread->get_ctaid().x << ", " << thread->get_ctaid().y << ", " << thread->get_ctaid().z <<
+                 "), thread (" << thread->get_tid().x << ", " << thread->get_tid().y << ", " << thread->get_tid().z <<
+                 ")");
+               thread->get_kernel().block_state[thread->get_block_idx()].thread.reset(thread->get_thread_idx());
+               DEV_RUNTIME_REPORT("Reset block state for block " << thread->get_block_idx() << " thread " << thread->get_thread_idx());
+            }
+            else if(device_grid == NULL) { //first time launch, as child kernel
 
                //create child kernel_info_t and index it with parameter_buffer address
                device_grid = new kernel_info_t(config.grid_dim, config.block_dim, device_kernel_entry);
@@ -1362,6 +1291,7 @@ void gpgpusim_cuda_launchDeviceV2(const ptx_instruction * pI, ptx_thread_info *
 	       device_kernel_param_mem = device_grid->get_param_memory(-1); //native kernel param
                thread->get_kernel().block_state[thread->get_block_idx()].thread.reset(thread->get_thread_idx());
                DEV_RUNTIME_REPORT("Reset block state for block " << thread->get_block_idx() << " thread " << thread->get_thread_idx());
+               if(g_cdp_warp_launch_batching && !g_agg_blocks_support) open_warp_launch_batch(pI, thread, device_grid);
             }
             else { //launched before, as aggregated blocks
 	       uintptr_t tmp = (uintptr_t)parameter_buffer;
@@ -1438,15 +1368,16 @@ void gpgpusim_cuda_launchDeviceV2(const ptx_instruction * pI, ptx_thread_info *
 	 if(g_dyn_child_thread_consolidation){
 	    //store offset value in kernel distributor entry
 	    unsigned int offset;
-	    device_kernel_param_mem->read((size_t)per_kernel_offset[g_app_name], 4, &offset);
+	    const dcc_param_layout_t *layout = dcc_get_param_layout(k_dis->kernel_grid->entry());
+	    device_kernel_param_mem->read((size_t)layout->offset_pos, 4, &offset);
 	    k_dis->offset_base = offset;
-	    DEV_RUNTIME_REPORT("DCC: reading the offset of kernel " << k_dis->kernel_grid->get_uid() << " to " << offset << " [address " << per_kernel_offset[g_app_name] << "]");
+	    DEV_RUNTIME_REPORT("DCC: reading the offset of kernel " << k_dis->kernel_grid->get_uid() << " to " << offset << " [address " << layout->offset_pos << "]");
 	 }
 
       }
       else if(arg == 1) { //cudaStream for the child kernel
          if(!g_dyn_child_thread_consolidation){
-            if(device_launch_op.op_name == DEVICE_LAUNCH_CHILD) {
+            if(warp_batch == NULL && device_launch_op.op_name == DEVICE_LAUNCH_CHILD) { //batched lanes share the stream of the first lane
                assert(size == sizeof(cudaStream_t));
                thread->m_local_mem->read(from_addr, size, &child_stream);
 
@@ -1489,7 +1420,7 @@ void gpgpusim_cuda_launchDeviceV2(const ptx_instruction * pI, ptx_thread_info *
    }
 
    //launch child kernel
-   if(!g_dyn_child_thread_consolidation){
+   if(!g_dyn_child_thread_consolidation && warp_batch == NULL){
       g_cuda_device_launch_op.push_back(device_launch_op);
    }
    g_cuda_device_launch_param_map.erase(parameter_buffer);
@@ -1642,6 +1573,25 @@ void try_launch_child_kernel(){
 #endif
 }
 
+/* number of core cycles, starting with the next one, in which the device launch step at the end of
+ * gpgpu_sim::cycle() (launch_one_device_kernel() or try_launch_child_kernel()) can neither launch nor
+ * consolidate a kernel; the only thing it may do is report the busy KCE */
+unsigned long long device_launch_idle_cycles(unsigned long long cycle){
+    if(!g_dyn_child_thread_consolidation)
+	return g_cuda_device_launch_op.empty() ? (unsigned long long)-1 : 0;
+    if(!g_ready_consolidated_kernels.empty()) return 0;
+    if(!pending_child_threads || !g_stream_manager->gpu_can_start_kernel()) return (unsigned long long)-1;
+    if(param_buffer_full) return (unsigned long long)-1; //launch_one_device_kernel() with nothing ready
+    if(dcc_get_consolidation_policy()->engine_available(cycle+1)) return 0;
+    return kernel_consolidation_engine_busy_until - cycle - 1;
+}
+
+/* state left by device launch steps skipped under device_launch_idle_cycles() */
+void device_launch_skip_idle(){
+    if(g_dyn_child_thread_consolidation && !(param_buffer_full && g_stream_manager->gpu_can_start_kernel()))
+	available_tdq_slot = g_stream_manager->gpu_can_start_kernel();
+}
+
 
 //Handling device runtime api:
 //cudaError_t cudaStreamCreateWithFlags ( cudaStream_t* pStream, unsigned int  flags)
@@ -1709,115 +1659,98 @@ void generate_one_consolidated_kernel(kernel_info_t *fin_parent, ptx_thread_info
     assert (fin_parent == NULL || sync_parent_thread == NULL); //either of these two pointers must be NULL
     if(!pending_child_threads) return; //immediately return if no pending child threads
     dev_launch_type launch_mode = (fin_parent != NULL) ? PARENT_FINISHED : ((sync_parent_thread != NULL) ? PARENT_BLOCK_SYNC : NORMAL);
-    if( g_estimate_offchip_metadata_load_latency ){
-	if( launch_mode == NORMAL && kernel_consolidation_engine_busy_until > gpu_sim_cycle+gpu_tot_sim_cycle ){
-	    printf("DKC: KCE is busy until cycle %lld\n", kernel_consolidation_engine_busy_until);
-	    return;
-	}
+    dcc_consolidation_policy *policy = dcc_get_consolidation_policy();
+    if( launch_mode == NORMAL && !policy->engine_available(gpu_sim_cycle+gpu_tot_sim_cycle) ){
+	printf("DKC: KCE is busy until cycle %lld\n", kernel_consolidation_engine_busy_until);
+	return;
     }
     bool found_target_entry = false;
     int target_merge_size = -1;
     bool remained = false;
-    std::list<dcc_kernel_distributor_t>::iterator it;
-
-    if ( !g_cuda_dcc_kernel_distributor.empty() ){
-//	if( g_cuda_dcc_kernel_distributor.size() > 1 ) g_cuda_dcc_kernel_distributor.sort(compare_kernelq_id_then_offset);
-	for(it = g_cuda_dcc_kernel_distributor.begin(); it != g_cuda_dcc_kernel_distributor.end(); it++){ //find a valid kd entry
-	    if(it->valid){ 
-		switch(launch_mode){
-		    case NORMAL:
-#if 0
-			if(g_app_name == KMEANS || g_app_name == MST || g_app_name == SP ){//(g_app_name == BC && it->kernel_grid->name().find(bc_k2) != std::string::npos) ) { //PCdep, do not genearte consolidated kernel in NORMAL mode
-			    found_target_entry = false;
-			    target_merge_size = -1;
-			    //DEV_RUNTIME_REPORT("DKC: PCdep, wait for cudaDeviceSynchronize.");
-			} else {
-#endif
-			    if(tdq_full && g_kernel_queue_entry_running == 0) {
-				found_target_entry = true;
-				target_merge_size = (pending_child_threads / it->optimal_block_size) * it->optimal_block_size;
-				DEV_RUNTIME_REPORT("DKC: MDB full but no device kernel has invoked --> potential deadlock --> force consolidation");
-			    } else {
-				unsigned global_optimal_kernel_size;
-				if( g_child_aware_smk_scheduling ){
-				    global_optimal_kernel_size = it->optimal_kernel_size;
-				} else {
-				    if( it->optimal_kernel_size < potential_child_threads / available_tdq_slot ) global_optimal_kernel_size = potential_child_threads / available_tdq_slot;
-				    else global_optimal_kernel_size = it->optimal_kernel_size;
-				}
-				if( pending_child_threads >= global_optimal_kernel_size ){
-				    found_target_entry = true;
-				    target_merge_size = (pending_child_threads / it->optimal_block_size) * it->optimal_block_size;
-				    //target_merge_size = it->optimal_kernel_size;
-				    DEV_RUNTIME_REPORT("DKC: enough pending child threads => generate consolidated kernel with " << target_merge_size << " threads, wb_kernel_size = " << potential_child_threads / available_tdq_slot );
-				}
-			    }
-#if 0
-			}
-#endif
-			break;
-		    case PARENT_FINISHED:
-			if (it->kernel_grid->get_parent() == fin_parent){ 
-			    found_target_entry = true;
-			    assert(it->kernel_grid->get_parent()->end_cycle != 0); //make sure that the parent kernel actually finished
-			    target_merge_size = -1;
-			    DEV_RUNTIME_REPORT("DKC: parent kernel " << fin_parent->get_uid() << " has finished => consolidate kernel with all its children.");
-			}
-			break;
-		    case PARENT_BLOCK_SYNC:
-			if (it->kernel_grid->get_parent() == &(sync_parent_thread->get_kernel()) ){
-			    std::list<ptx_thread_info *>::iterator parent_it = it->kernel_grid->m_parent_threads.begin();
-			    unsigned tmp_block_idx = (*parent_it)->get_block_idx();
-			    if( tmp_block_idx == sync_parent_thread->get_block_idx()){                   
-				found_target_entry = true;
-				target_merge_size = -1;
-				DEV_RUNTIME_REPORT("DKC: PCdep, parent block " << sync_parent_thread->get_block_idx() << " has called cudaDeviceSynchronize => consolidate kernel with the block's children.");
-			    }
-			}
-			break;
-		    default:
-			DEV_RUNTIME_REPORT("DKC: unsupported device launch mode");
-			assert(0);
-			break;
-		}
+    dcc_kd_iter_t it;
+
+    if ( !g_dcc_kd_buckets.empty() ){
+	/* the target entry is the earliest-arriving valid entry that fits the launch mode;
+	 * entries of a bucket share their optimal sizes, so only each bucket's head has to be checked */
+	std::map<dcc_kd_key_t, dcc_kd_bucket_t>::iterator bk;
+	bool force_consolidation = (launch_mode == NORMAL) && tdq_full && g_kernel_queue_entry_running == 0;
+	for(bk = g_dcc_kd_buckets.begin(); bk != g_dcc_kd_buckets.end(); bk++){
+	    dcc_kd_seq_map_t *candidates = &(bk->second.entries);
+	    int head_target_size = -1;
+	    switch(launch_mode){
+		case NORMAL:
+		    if( force_consolidation ){
+			dcc_kernel_distributor_t &head = *(candidates->begin()->second);
+			head_target_size = (pending_child_threads / head.optimal_block_size) * head.optimal_block_size;
+		    } else if( !policy->should_consolidate(*(candidates->begin()->second), head_target_size) ){
+			candidates = NULL;
+		    }
+		    break;
+		case PARENT_FINISHED:
+		    if( bk->first.second != fin_parent ) candidates = NULL;
+		    break;
+		case PARENT_BLOCK_SYNC:
+		    if( bk->first.second != &(sync_parent_thread->get_kernel()) ){
+			candidates = NULL;
+		    } else {
+			std::map<unsigned, dcc_kd_seq_map_t>::iterator blk = bk->second.block_entries.find(sync_parent_thread->get_block_idx());
+			candidates = (blk != bk->second.block_entries.end()) ? &(blk->second) : NULL;
+		    }
+		    break;
+		default:
+		    DEV_RUNTIME_REPORT("DKC: unsupported device launch mode");
+		    assert(0);
+		    break;
+	    }
+	    if( candidates == NULL ) continue;
+	    dcc_kd_iter_t head = candidates->begin()->second;
+	    if( !found_target_entry || head->kd_seq < it->kd_seq ){
+		found_target_entry = true;
+		it = head;
+		target_merge_size = head_target_size;
 	    }
-	    if(found_target_entry) break;
 	}
 
 	if(!found_target_entry) return;
 
-	unsigned consolidation_count = 0, offchip_metadata_count = 0;
-	if(g_cuda_dcc_kernel_distributor.size() > 1){ //more than one metadata, do merge stuff
-	    std::list<dcc_kernel_distributor_t>::iterator it2;
-	    for(it2=g_cuda_dcc_kernel_distributor.begin(); it2!=g_cuda_dcc_kernel_distributor.end(); it2++){
+	switch(launch_mode){
+	    case NORMAL:
+		if(force_consolidation) {
+		    DEV_RUNTIME_REPORT("DKC: MDB full but no device kernel has invoked --> potential deadlock --> force consolidation");
+		} else {
+		    DEV_RUNTIME_REPORT("DKC: " << policy->name() << " policy => generate consolidated kernel with " << target_merge_size << " threads, wb_kernel_size = " << potential_child_threads / available_tdq_slot );
+		}
+		break;
+	    case PARENT_FINISHED:
+		assert(it->kernel_grid->get_parent()->end_cycle != 0); //make sure that the parent kernel actually finished
+		DEV_RUNTIME_REPORT("DKC: parent kernel " << fin_parent->get_uid() << " has finished => consolidate kernel with all its children.");
+		break;
+	    case PARENT_BLOCK_SYNC:
+		DEV_RUNTIME_REPORT("DKC: PCdep, parent block " << sync_parent_thread->get_block_idx() << " has called cudaDeviceSynchronize => consolidate kernel with the block's children.");
+		break;
+	    default:
+		break;
+	}
+
+	unsigned consolidation_count = 0;
+	dcc_kd_bucket_t &bucket = g_dcc_kd_buckets[dcc_kd_key(*it)];
+	if(bucket.entries.size() > 1){ //more than one metadata of the same kernel and parent, do merge stuff
+	    dcc_kd_seq_map_t &candidates = (launch_mode == PARENT_BLOCK_SYNC) ? bucket.block_entries[sync_parent_thread->get_block_idx()] : bucket.entries;
+	    dcc_kd_seq_map_t::iterator c = candidates.begin();
+	    while( c != candidates.end() ){
+		dcc_kd_iter_t it2 = (c++)->second; //advance first, a merged entry is removed from the index
+		if( it2 == it ) continue;
 		remained = false;
-		if( (it2->valid) && (it2!=it) && 
-		    (!it->kernel_grid->name().compare(it2->kernel_grid->name())) && 
-		    (it->kernel_grid->get_parent() == it2->kernel_grid->get_parent()) ){ //valid, different entry, same kernel name, same parent
-		    if( launch_mode == PARENT_BLOCK_SYNC && (it2->kernel_grid->m_parent_threads.front())->get_block_idx() != sync_parent_thread->get_block_idx() ) { //additional constraint
-			continue;
-		    }
-		    bool merged = merge_two_kernel_distributor_entry(&(*it), &(*it2), true, target_merge_size, remained);
-		    if(merged){
-#if 0
-			it->kernel_grid->metadata_count++;
-			if(it2->kernel_queue_entry_id == -1){
-			    offchip_metadata_count++;
-			} else {
-			    it->onchip_metadata++;
-			}
-#endif
-			if(!remained){
-			    // invalidate and erase kernel 2
-			    it2->valid = false;
-			    it2 = g_cuda_dcc_kernel_distributor.erase(it2);
-			    it2--;
-			}
-//			DEV_RUNTIME_REPORT("DKC: successfully merged, kernel distrubutor now has " << g_cuda_dcc_kernel_distributor.size() << " entries.");
-			consolidation_count ++;
+		bool merged = merge_two_kernel_distributor_entry(&(*it), &(*it2), true, target_merge_size, remained);
+		if(merged){
+		    if(!remained){
+			// invalidate and erase kernel 2
+			it2->valid = false;
+			dcc_kd_erase(it2);
 		    }
-		    if ( target_merge_size != -1 && it->thread_count >= target_merge_size) break; //termination criterion for NORMAL mode
+		    consolidation_count ++;
 		}
+		if ( target_merge_size != -1 && it->thread_count >= target_merge_size) break; //termination criterion for NORMAL mode
 	    }
 	}
 
@@ -1852,7 +1785,7 @@ void generate_one_consolidated_kernel(kernel_info_t *fin_parent, ptx_thread_info
 
 	/* move consolidated kernel from task distributor to ready list */
 	g_ready_consolidated_kernels.push_back(*it);
-	g_cuda_dcc_kernel_distributor.erase(it);
+	dcc_kd_erase(it);
     }
 }
 
@@ -1862,6 +1795,8 @@ void launch_one_device_kernel(bool no_more_kernel, kernel_info_t *fin_parent, pt
          device_launch_operation_t &op = g_cuda_device_launch_op.front();
 
          if(op.op_name == DEVICE_LAUNCH_CHILD) {
+            if(op.agg_block_group != NULL) //lanes batched into this launch
+               op.grid->add_agg_block_group(op.agg_block_group);
             stream_operation stream_op = stream_operation(op.grid, g_ptx_sim_mode, op.stream);
             g_stream_manager->push(stream_op);
 //	    printf("push device-launched kernel into stream manager\n");
@@ -2067,17 +2002,11 @@ void launch_one_device_kernel(bool no_more_kernel, kernel_info_t *fin_parent, pt
 void gpgpusim_cuda_deviceSynchronize(const ptx_instruction * pI, ptx_thread_info * thread, const function_info * target_func) {
    DEV_RUNTIME_REPORT("Calling cudaDeviceSynchronize");
    unsigned parent_block_idx = thread->get_block_idx();
-   std::list<dcc_kernel_distributor_t>::iterator it;
    bool has_child_kernels = false;
    if(!thread->get_kernel().block_state[parent_block_idx].thread.all()){ //a block has child kernel only if some thread turn-off its bit in block state
       has_child_kernels = true;
    }else if(g_dyn_child_thread_consolidation){
-      for(it=g_cuda_dcc_kernel_distributor.begin(); it!=g_cuda_dcc_kernel_distributor.end(); it++){
-         if((it->kernel_grid->m_parent_threads.front())->get_block_idx() == parent_block_idx){
-            has_child_kernels = true;
-            break;
-         }
-      }
+      has_child_kernels = g_dcc_kd_block_count.find(std::make_pair(&(thread->get_kernel()), parent_block_idx)) != g_dcc_kd_block_count.end();
    }
 
    char mech[5], sche[5];
@@ -2142,6 +2071,59 @@ void launch_all_device_kernels() {
    }
 }
 
+//Warp-level launch batching: active lanes of one warp that execute the same
+//cudaLaunchDeviceV2 in the same cycle share the child grid created by the first
+//lane. The other lanes are appended to one agg_block_group_t per warp, a table
+//with one entry and one parameter slice per lane, which is added to the grid by
+//the launch op of the first lane.
+struct warp_launch_batch_t {
+   const ptx_instruction *pI;
+   unsigned sid, wid;
+   unsigned long long cycle;
+   kernel_info_t *grid;
+   agg_block_group_t *group;
+   std::bitset<MAX_WARP_SIZE> lanes;
+};
+static warp_launch_batch_t g_warp_launch_batch = { NULL, 0, 0, 0, NULL, NULL };
+
+static unsigned warp_launch_lane( ptx_thread_info *thread ) {
+   return thread->get_hw_tid() % thread->get_gpu()->wrp_size();
+}
+
+agg_block_group_t * join_warp_launch_batch(const ptx_instruction *pI, ptx_thread_info *thread, function_info *kernel_entry, dim3 block_dim) {
+   warp_launch_batch_t &b = g_warp_launch_batch;
+   if(b.grid == NULL || b.pI != pI || b.cycle != gpu_sim_cycle + gpu_tot_sim_cycle) return NULL;
+   if(b.sid != thread->get_hw_sid() || b.wid != thread->get_hw_wid()) return NULL;
+   if(b.grid->entry() != kernel_entry || b.grid->get_parent() != &thread->get_kernel()) return NULL;
+   dim3 cta = b.grid->get_cta_dim();
+   if(cta.x != block_dim.x || cta.y != block_dim.y || cta.z != block_dim.z) return NULL;
+   unsigned lane = warp_launch_lane(thread);
+   if(b.lanes.test(lane)) return NULL;
+   b.lanes.set(lane);
+   if(b.group == NULL) {
+      //every launch of a batch is issued in the same cycle, so the first lane's op is still queued last
+      device_launch_operation_t &op = g_cuda_device_launch_op.back();
+      assert(op.grid == b.grid && op.op_name == DEVICE_LAUNCH_CHILD && op.agg_block_group == NULL);
+      b.group = new agg_block_group_t(block_dim, b.grid, thread->get_gpu()->wrp_size() - 1, kernel_entry->get_args_aligned_size());
+      op.agg_block_group = b.group;
+      b.grid->unissued_agg_groups++; //preventing the kernel from termination
+   }
+   DEV_RUNTIME_REPORT("warp launch batching: lane " << lane << " joins child kernel " << b.grid->get_uid());
+   return b.group;
+}
+
+void open_warp_launch_batch(const ptx_instruction *pI, ptx_thread_info *thread, kernel_info_t *grid) {
+   warp_launch_batch_t &b = g_warp_launch_batch;
+   b.pI = pI;
+   b.sid = thread->get_hw_sid();
+   b.wid = thread->get_hw_wid();
+   b.cycle = gpu_sim_cycle + gpu_tot_sim_cycle;
+   b.grid = grid;
+   b.group = NULL;
+   b.lanes.reset();
+   b.lanes.set(warp_launch_lane(thread));
+}
+
 kernel_info_t * find_launched_grid(function_info * kernel_entry, kernel_info_t *parent_kernel, unsigned parent_block_idx) {
     if(g_agg_blocks_support) {
 	kernel_info_t * grid;
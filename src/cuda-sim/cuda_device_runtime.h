@@ -6,6 +6,7 @@
 #pragma once
 
 extern bool g_agg_blocks_support;
+extern bool g_cdp_warp_launch_batching;
 
 //Po-Han: dynamic child-thread consolidation support
 class dcc_kernel_distributor_t {
@@ -33,7 +34,9 @@ class dcc_kernel_distributor_t {
             agg_group_id(_agg_group_id),
             ctaid(_ctaid),
    	    expected_launch_time(0),
-   	    offset_base(0xFFFFFFFF){}
+   	    offset_base(0xFFFFFFFF),
+	    kd_seq(0),
+	    parent_block_idx(0){}
 
 	bool valid, candidate, launched;
 	kernel_info_t *kernel_grid;
@@ -49,6 +52,8 @@ class dcc_kernel_distributor_t {
 	unsigned int offset_base;
 	int kernel_queue_entry_id;
 	unsigned int onchip_metadata;
+	unsigned long long kd_seq;	// arrival order in the kernel distributor
+	unsigned parent_block_idx;	// block of the launching parent thread
 };
 extern bool g_dyn_child_thread_consolidation;	
 extern unsigned g_dcc_timeout_threshold;
@@ -72,6 +77,81 @@ typedef enum _application_id {
     BL
 } application_id;
 //extern application_id g_app_name;
+
+//Child kernel parameter layout used by consolidation: where the thread offset,
+//thread count and shared constants live in a child's parameter buffer (byte positions).
+//Built once per child function from -dcc_param_layout_file, or from the
+//application id tables when the kernel is not listed there.
+struct dcc_param_layout_t {
+	int offset_pos;               // first thread index handled by the child
+	int total_thread_pos;         // number of child threads
+	std::vector<int> shift_pos;   // fields rebased by the merged thread count (includes offset_pos)
+	int strided_pos;              // field rebased by thread count * stride (-1: none)
+	int stride_pos;
+	int const_pos;                // start of params shared by all children (-1: none)
+	std::vector<std::pair<unsigned,unsigned> > const_pc; // [first,last] PCs of the loads of those params
+	unsigned param_size;          // bytes copied when a parameter buffer is split
+	bool splittable;              // may be cut at a target kernel size
+	bool same_parent_block;       // only merge children of the same parent block
+};
+const dcc_param_layout_t *dcc_get_param_layout( function_info *kernel );
+bool dcc_is_global_constant_pc( unsigned pc );
+
+//Po-Han DKC: consolidation policy of the kernel consolidation engine (KCE), selected by -dcc_consolidation_policy.
+//In NORMAL launch mode the policy decides whether the child kernels behind a distributor entry are
+//consolidated now and how many threads are gathered; it also shapes the consolidated kernels.
+//PARENT_FINISHED / PARENT_BLOCK_SYNC always consolidate everything that is left.
+class dcc_consolidation_policy {
+public:
+	dcc_consolidation_policy( class gpgpu_sim *gpu ) : m_gpu(gpu) {}
+	virtual ~dcc_consolidation_policy() {}
+
+	virtual const char *name() const = 0;
+	//false while the KCE is still busy with earlier work
+	virtual bool engine_available( unsigned long long cycle ) const;
+	//threads per block and per consolidated kernel for a child function
+	virtual void launch_shape( function_info *child, unsigned &threads_per_block, unsigned &threads_per_kernel ) const;
+	//target_size is the thread count to gather, -1 for all pending threads
+	virtual bool should_consolidate( const dcc_kernel_distributor_t &head, int &target_size ) = 0;
+
+protected:
+	class gpgpu_sim *m_gpu;
+};
+
+//consolidate once the pending threads fill an optimally sized kernel (default)
+class dcc_threshold_policy : public dcc_consolidation_policy {
+public:
+	dcc_threshold_policy( class gpgpu_sim *gpu ) : dcc_consolidation_policy(gpu) {}
+	virtual const char *name() const { return "threshold"; }
+	virtual bool should_consolidate( const dcc_kernel_distributor_t &head, int &target_size );
+};
+
+//threshold, or the oldest child has waited longer than -dcc_timeout_threshold cycles
+class dcc_timeout_policy : public dcc_threshold_policy {
+public:
+	dcc_timeout_policy( class gpgpu_sim *gpu ) : dcc_threshold_policy(gpu) {}
+	virtual const char *name() const { return "timeout"; }
+	virtual bool should_consolidate( const dcc_kernel_distributor_t &head, int &target_size );
+};
+
+//consolidate as many whole blocks as the SMs currently have free thread slots for
+class dcc_occupancy_policy : public dcc_consolidation_policy {
+public:
+	dcc_occupancy_policy( class gpgpu_sim *gpu ) : dcc_consolidation_policy(gpu) {}
+	virtual const char *name() const { return "occupancy"; }
+	virtual bool should_consolidate( const dcc_kernel_distributor_t &head, int &target_size );
+};
+
+//consolidate whenever at least one warp of child threads is pending
+class dcc_warp_policy : public dcc_consolidation_policy {
+public:
+	dcc_warp_policy( class gpgpu_sim *gpu ) : dcc_consolidation_policy(gpu) {}
+	virtual const char *name() const { return "warp"; }
+	virtual bool should_consolidate( const dcc_kernel_distributor_t &head, int &target_size );
+};
+
+dcc_consolidation_policy *dcc_get_consolidation_policy();
+
 //extern std::list<dcc_kernel_distributor_t *> g_cuda_dcc_kernel_distributor;
 bool compare_dcc_kd_entry(const dcc_kernel_distributor_t &a, const dcc_kernel_distributor_t &b);
 
@@ -82,9 +162,14 @@ void launch_all_device_kernels();
 void launch_one_device_kernel(bool no_more_kernel, kernel_info_t *fin_parent, ptx_thread_info *sync_parent_thread);
 void generate_one_consolidated_kernel(kernel_info_t *fin_parent, ptx_thread_info *sync_parent_thread);
 void try_launch_child_kernel();
+unsigned long long device_launch_idle_cycles(unsigned long long cycle);
+void device_launch_skip_idle();
 kernel_info_t * find_launched_grid(function_info * kernel_entry, kernel_info_t *parent_kernel, unsigned parent_block_idx);
 //kernel_info_t * find_launched_grid(function_info * kernel_entry);
+agg_block_group_t * join_warp_launch_batch(const ptx_instruction *pI, ptx_thread_info *thread, function_info *kernel_entry, dim3 block_dim);
+void open_warp_launch_batch(const ptx_instruction *pI, ptx_thread_info *thread, kernel_info_t *grid);
 
 void gpgpusim_cuda_deviceSynchronize(const ptx_instruction * pI, ptx_thread_info * thread, const function_info * target_func);
+void dcc_kernel_distributor_retire(kernel_info_t *kernel);
 bool merge_two_kernel_distributor_entry(dcc_kernel_distributor_t *kd_entry_1, dcc_kernel_distributor_t *kd_entry_2, bool ForceMerge, int target_size, bool &remaining);
 bool is_target_parent_kernel(kernel_info_t *kernel);
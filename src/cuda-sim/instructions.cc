@@ -59,6 +59,44 @@ ptx_reg_t srcOperandModifiers(ptx_reg_t opData, operand_info opInfo, operand_inf
 
 void sign_extend( ptx_reg_t &data, unsigned src_size, const operand_info &dst );
 
+void reg_frame_t::bind( const function_info *func )
+{
+   assert( m_func == NULL && m_num_valid == 0 );
+   m_func = func;
+   m_values.resize( func->num_reg_slots() );
+   m_valid.resize( func->num_reg_slots(), false );
+}
+
+ptx_reg_t *reg_frame_t::find( const symbol *reg )
+{
+   if( m_func == NULL && reg->reg_slot_func() != NULL ) 
+      bind( reg->reg_slot_func() );
+   if( reg->reg_slot_func() == m_func && m_func != NULL ) {
+      unsigned slot = reg->reg_slot();
+      return m_valid[slot] ? &m_values[slot] : NULL;
+   }
+   reg_map_t::iterator r = m_other.find(reg);
+   if( r == m_other.end() ) 
+      return NULL;
+   return &r->second;
+}
+
+ptx_reg_t &reg_frame_t::operator[]( const symbol *reg )
+{
+   if( m_func == NULL && reg->reg_slot_func() != NULL ) 
+      bind( reg->reg_slot_func() );
+   if( reg->reg_slot_func() == m_func && m_func != NULL ) {
+      unsigned slot = reg->reg_slot();
+      if( !m_valid[slot] ) {
+         m_valid[slot] = true;
+         m_values[slot] = ptx_reg_t();
+         m_num_valid++;
+      }
+      return m_values[slot];
+   }
+   return m_other[reg];
+}
+
 void ptx_thread_info::set_reg( const symbol *reg, const ptx_reg_t &value ) 
 {
    assert( reg != NULL );
@@ -76,8 +114,8 @@ ptx_reg_t ptx_thread_info::get_reg( const symbol *reg )
    static bool unfound_register_warned = false;
    assert( reg != NULL );
    assert( !m_regs.empty() );
-   reg_map_t::iterator regs_iter = m_regs.back().find(reg);
-   if (regs_iter == m_regs.back().end()) {
+   ptx_reg_t *value = m_regs.back().find(reg);
+   if (value == NULL) {
       assert( reg->type()->get_key().is_reg() );
       const std::string &name = reg->name();
       unsigned call_uid = m_callstack.back().m_call_uid;
@@ -91,15 +129,19 @@ ptx_reg_t ptx_thread_info::get_reg( const symbol *reg )
                  file_loc.c_str(), name.c_str(), call_uid );
           unfound_register_warned = true;
       }
-      regs_iter = m_regs.back().find(reg);
+      value = m_regs.back().find(reg);
    }
    if (m_enable_debug_trace ) 
-      m_debug_trace_regs_read.back()[ reg ] = regs_iter->second;
-   return regs_iter->second;
+      m_debug_trace_regs_read.back()[ reg ] = *value;
+   return *value;
 }
 
-ptx_reg_t ptx_thread_info::get_operand_value( const operand_info &op, operand_info dstInfo, unsigned opType, ptx_thread_info *thread, int derefFlag )
+ptx_reg_t ptx_thread_info::get_operand_value( const operand_info &op, const operand_info &dstInfo, unsigned opType, ptx_thread_info *thread, int derefFlag )
 {
+   // common case: plain register read, no addressing/lohi/negation to apply
+   if( op.is_plain_reg() && (opType != BB128_TYPE) && (opType != BB64_TYPE) && (opType != FF64_TYPE) )
+      return get_reg( op.get_symbol() );
+
    ptx_reg_t result, tmp;
 
 
@@ -338,9 +380,9 @@ void ptx_thread_info::get_vector_operand_values( const operand_info &op, ptx_reg
       const symbol *sym = NULL;
       sym = op.vec_symbol(idx);
       if( strcmp(sym->name().c_str(),"_") != 0) {
-         reg_map_t::iterator reg_iter = m_regs.back().find(sym);
-         assert( reg_iter != m_regs.back().end() );
-         ptx_regs[idx] = reg_iter->second;
+         ptx_reg_t *value = m_regs.back().find(sym);
+         assert( value != NULL );
+         ptx_regs[idx] = *value;
       }
    }
 }
@@ -27,12 +27,18 @@
 
 #include "memory.h"
 #include <stdlib.h>
+#include <sys/mman.h>
 #include "../debug.h"
 
-template<unsigned BSIZE> memory_space_impl<BSIZE>::memory_space_impl( std::string name, unsigned hash_size )
+#define MEM_FLAT_SPACE_SIZE (1ULL<<(8*sizeof(mem_addr_t)))
+
+template<unsigned BSIZE> memory_space_impl<BSIZE>::memory_space_impl( std::string name, unsigned hash_size, bool flat )
 {
    m_name = name;
-   MEM_MAP_RESIZE(hash_size);
+   m_mru_index = (mem_addr_t)-1;
+   m_mru_block = NULL;
+   m_flat = NULL;
+   m_observer = NULL;
 
    m_log2_block_size = -1;
    for( unsigned n=0, mask=1; mask != 0; mask <<= 1, n++ ) {
@@ -42,6 +48,66 @@ template<unsigned BSIZE> memory_space_impl<BSIZE>::memory_space_impl( std::strin
       }
    }
    assert( m_log2_block_size != (unsigned)-1 );
+
+   if( flat ) {
+      // pages are only committed by the OS when first touched
+      void *p = mmap( NULL, MEM_FLAT_SPACE_SIZE, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0 );
+      if( p == MAP_FAILED ) {
+         printf("GPGPU-Sim PTX: WARNING could not map flat backing store for memory \'%s\', using page table\n", m_name.c_str() );
+      } else {
+         m_flat = (unsigned char*)p;
+         m_flat_touched.resize( MEM_FLAT_SPACE_SIZE >> m_log2_block_size, false );
+      }
+   }
+}
+
+template<unsigned BSIZE> memory_space_impl<BSIZE>::~memory_space_impl()
+{
+   for( unsigned d=0; d < m_dir.size(); d++ ) {
+      if( m_dir[d] == NULL ) 
+         continue;
+      for( unsigned b=0; b < MEM_LEAF_SIZE; b++ ) 
+         delete m_dir[d][b];
+      delete[] m_dir[d];
+   }
+   if( m_flat ) 
+      munmap( m_flat, MEM_FLAT_SPACE_SIZE );
+}
+
+template<unsigned BSIZE> mem_storage<BSIZE> *memory_space_impl<BSIZE>::get_block( mem_addr_t blk_idx )
+{
+   mem_storage<BSIZE> *blk = find_block(blk_idx);
+   if( blk ) {
+      m_mru_index = blk_idx;
+      m_mru_block = blk;
+      return blk;
+   }
+   mem_addr_t dir_idx = blk_idx >> MEM_LEAF_BITS;
+   if( dir_idx >= m_dir.size() ) 
+      m_dir.resize( dir_idx+1, NULL );
+   if( m_dir[dir_idx] == NULL ) {
+      m_dir[dir_idx] = new mem_storage<BSIZE>*[MEM_LEAF_SIZE];
+      for( unsigned b=0; b < MEM_LEAF_SIZE; b++ ) 
+         m_dir[dir_idx][b] = NULL;
+   }
+   blk = new mem_storage<BSIZE>();
+   m_dir[dir_idx][blk_idx & (MEM_LEAF_SIZE-1)] = blk;
+   m_mru_index = blk_idx;
+   m_mru_block = blk;
+   return blk;
+}
+
+template<unsigned BSIZE> void memory_space_impl<BSIZE>::write_single_block( mem_addr_t blk_idx, unsigned offset, size_t length, const unsigned char *data )
+{
+   if( m_observer ) 
+      m_observer->touch(this, blk_idx, BSIZE, true);
+   if( m_flat ) {
+      assert( offset + length <= BSIZE );
+      memcpy( m_flat + ((size_t)blk_idx << m_log2_block_size) + offset, data, length );
+      m_flat_touched[blk_idx] = true;
+   } else {
+      get_block(blk_idx)->write(offset,length,data);
+   }
 }
 
 template<unsigned BSIZE> void memory_space_impl<BSIZE>::write( mem_addr_t addr, size_t length, const void *data, class ptx_thread_info *thd, const ptx_instruction *pI)
@@ -51,7 +117,7 @@ template<unsigned BSIZE> void memory_space_impl<BSIZE>::write( mem_addr_t addr,
       // fast route for intra-block access 
       unsigned offset = addr & (BSIZE-1);
       unsigned nbytes = length;
-      m_data[index].write(offset,nbytes,(const unsigned char*)data);
+      write_single_block(index,offset,nbytes,(const unsigned char*)data);
    } else {
       // slow route for inter-block access
       unsigned nbytes_remain = length;
@@ -67,7 +133,7 @@ template<unsigned BSIZE> void memory_space_impl<BSIZE>::write( mem_addr_t addr,
          } 
          
          size_t tx_bytes = access_limit - offset; 
-         m_data[page].write(offset, tx_bytes, &((const unsigned char*)data)[src_offset]);
+         write_single_block(page, offset, tx_bytes, &((const unsigned char*)data)[src_offset]);
 
          // advance pointers 
          src_offset += tx_bytes; 
@@ -95,15 +161,22 @@ template<unsigned BSIZE> void memory_space_impl<BSIZE>::read_single_block( mem_a
              (addr+length),(blk_idx+1)*BSIZE, blk_idx, BSIZE);
       throw 1;
    }
-   typename map_t::const_iterator i = m_data.find(blk_idx);
-   if( i == m_data.end() ) {
+   if( m_observer ) 
+      m_observer->touch(const_cast<memory_space_impl<BSIZE>*>(this), blk_idx, BSIZE, false);
+   if( m_flat ) {
+      // untouched pages of the mapping read as zero
+      memcpy(data, m_flat + addr, length);
+      return;
+   }
+   const mem_storage<BSIZE> *blk = find_block(blk_idx);
+   if( blk == NULL ) {
       for( size_t n=0; n < length; n++ ) 
          ((unsigned char*)data)[n] = (unsigned char) 0;
       //printf("GPGPU-Sim PTX:  WARNING reading %zu bytes from unititialized memory at address 0x%x in space %s\n", length, addr, m_name.c_str() );
    } else {
       unsigned offset = addr & (BSIZE-1);
       unsigned nbytes = length;
-      i->second.read(offset,nbytes,(unsigned char*)data);
+      blk->read(offset,nbytes,(unsigned char*)data);
    }
 }
 
@@ -141,10 +214,26 @@ template<unsigned BSIZE> void memory_space_impl<BSIZE>::read( mem_addr_t addr, s
 
 template<unsigned BSIZE> void memory_space_impl<BSIZE>::print( const char *format, FILE *fout ) const
 {
-   typename map_t::const_iterator i_page;
-   for (i_page = m_data.begin(); i_page != m_data.end(); ++i_page) {
-      fprintf(fout, "%s - %#x:", m_name.c_str(), i_page->first);
-      i_page->second.print(format, fout);
+   if( m_flat ) {
+      for( mem_addr_t b=0; b < m_flat_touched.size(); b++ ) {
+         if( !m_flat_touched[b] ) 
+            continue;
+         mem_storage<BSIZE> blk;
+         blk.write(0,BSIZE,m_flat + ((size_t)b << m_log2_block_size));
+         fprintf(fout, "%s - %#x:", m_name.c_str(), b);
+         blk.print(format, fout);
+      }
+      return;
+   }
+   for( unsigned d=0; d < m_dir.size(); d++ ) {
+      if( m_dir[d] == NULL ) 
+         continue;
+      for( unsigned b=0; b < MEM_LEAF_SIZE; b++ ) {
+         if( m_dir[d][b] == NULL ) 
+            continue;
+         fprintf(fout, "%s - %#x:", m_name.c_str(), (d << MEM_LEAF_BITS) + b);
+         m_dir[d][b]->print(format, fout);
+      }
    }
 }
 
@@ -153,6 +242,70 @@ template<unsigned BSIZE> void memory_space_impl<BSIZE>::set_watch( addr_t addr,
    m_watchpoints[watchpoint]=addr;
 }
 
+// image format: (block index, BSIZE bytes) records ending with index (mem_addr_t)-1
+template<unsigned BSIZE> void memory_space_impl<BSIZE>::save( FILE *fp ) const
+{
+   if( m_flat ) {
+      for( mem_addr_t b=0; b < m_flat_touched.size(); b++ ) {
+         if( !m_flat_touched[b] ) 
+            continue;
+         fwrite(&b, sizeof(b), 1, fp);
+         fwrite(m_flat + ((size_t)b << m_log2_block_size), BSIZE, 1, fp);
+      }
+   } else {
+      unsigned char data[BSIZE];
+      for( unsigned d=0; d < m_dir.size(); d++ ) {
+         if( m_dir[d] == NULL ) 
+            continue;
+         for( unsigned b=0; b < MEM_LEAF_SIZE; b++ ) {
+            if( m_dir[d][b] == NULL ) 
+               continue;
+            mem_addr_t blk_idx = (d << MEM_LEAF_BITS) + b;
+            m_dir[d][b]->read(0,BSIZE,data);
+            fwrite(&blk_idx, sizeof(blk_idx), 1, fp);
+            fwrite(data, BSIZE, 1, fp);
+         }
+      }
+   }
+   mem_addr_t end = (mem_addr_t)-1;
+   fwrite(&end, sizeof(end), 1, fp);
+}
+
+template<unsigned BSIZE> bool memory_space_impl<BSIZE>::load( FILE *fp )
+{
+   // drop the current contents so that blocks absent from the image read as zero
+   if( m_flat ) {
+      for( mem_addr_t b=0; b < m_flat_touched.size(); b++ ) {
+         if( m_flat_touched[b] ) {
+            memset(m_flat + ((size_t)b << m_log2_block_size), 0, BSIZE);
+            m_flat_touched[b] = false;
+         }
+      }
+   } else {
+      for( unsigned d=0; d < m_dir.size(); d++ ) {
+         if( m_dir[d] == NULL ) 
+            continue;
+         for( unsigned b=0; b < MEM_LEAF_SIZE; b++ ) 
+            delete m_dir[d][b];
+         delete[] m_dir[d];
+      }
+      m_dir.clear();
+      m_mru_index = (mem_addr_t)-1;
+      m_mru_block = NULL;
+   }
+   unsigned char data[BSIZE];
+   while( true ) {
+      mem_addr_t blk_idx;
+      if( fread(&blk_idx, sizeof(blk_idx), 1, fp) != 1 ) 
+         return false;
+      if( blk_idx == (mem_addr_t)-1 ) 
+         return true;
+      if( fread(data, BSIZE, 1, fp) != 1 ) 
+         return false;
+      write_single_block(blk_idx, 0, BSIZE, data);
+   }
+}
+
 template class memory_space_impl<32>;
 template class memory_space_impl<64>;
 template class memory_space_impl<256>;
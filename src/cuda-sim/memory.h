@@ -30,19 +30,12 @@
 
 #include "../abstract_hardware_model.h"
 
-#include "../tr1_hash_map.h"
-#define mem_map tr1_hash_map
-#if tr1_hash_map_ismap == 1
-   #define MEM_MAP_RESIZE(hash_size) 
-#else
-   #define MEM_MAP_RESIZE(hash_size) (m_data.rehash(hash_size))
-#endif
-
 #include <assert.h>
 #include <string.h>
 #include <stdio.h>
 #include <string>
 #include <map>
+#include <vector>
 #include <stdlib.h>
 
 typedef address_type mem_addr_t;
@@ -98,6 +91,15 @@ private:
 
 class ptx_thread_info;
 class ptx_instruction;
+class memory_space;
+
+// notified before each block of a memory space is read or written
+class mem_touch_observer
+{
+public:
+   virtual ~mem_touch_observer() {}
+   virtual void touch( memory_space *mem, mem_addr_t blk_idx, unsigned bsize, bool write ) = 0;
+};
 
 class memory_space
 {
@@ -107,23 +109,60 @@ public:
    virtual void read( mem_addr_t addr, size_t length, void *data ) const = 0;
    virtual void print( const char *format, FILE *fout ) const = 0;
    virtual void set_watch( addr_t addr, unsigned watchpoint ) = 0;
+   // binary image of the written blocks, used by simulation checkpoints
+   virtual void save( FILE *fp ) const = 0;
+   virtual bool load( FILE *fp ) = 0;
+   virtual void set_observer( mem_touch_observer *observer ) = 0;
 };
 
+/*
+ * Blocks of BSIZE bytes are found through a two-level page table (a directory
+ * of leaves, each holding MEM_LEAF_SIZE block pointers) that grows on demand,
+ * with the most recently written block cached in front of it.  With flat=true the
+ * whole 32-bit space is instead backed by one lazily-committed anonymous
+ * mapping, falling back to the page table if the mapping cannot be created.
+ */
+#define MEM_LEAF_BITS 6
+#define MEM_LEAF_SIZE (1<<MEM_LEAF_BITS)
+
 template<unsigned BSIZE> class memory_space_impl : public memory_space {
 public:
-   memory_space_impl( std::string name, unsigned hash_size );
+   memory_space_impl( std::string name, unsigned hash_size, bool flat = false );
+   virtual ~memory_space_impl();
 
    virtual void write( mem_addr_t addr, size_t length, const void *data, ptx_thread_info *thd, const ptx_instruction *pI );
    virtual void read( mem_addr_t addr, size_t length, void *data ) const;
    virtual void print( const char *format, FILE *fout ) const;
    virtual void set_watch( addr_t addr, unsigned watchpoint ); 
+   virtual void save( FILE *fp ) const;
+   virtual bool load( FILE *fp );
+   virtual void set_observer( mem_touch_observer *observer ) { m_observer = observer; }
 
 private:
+   memory_space_impl( const memory_space_impl &another ); // not copyable: owns its blocks
    void read_single_block( mem_addr_t blk_idx, mem_addr_t addr, size_t length, void *data) const; 
+   void write_single_block( mem_addr_t blk_idx, unsigned offset, size_t length, const unsigned char *data );
+   // the MRU entry is only updated by get_block() on the write path, so
+   // concurrent const reads never store to this object
+   mem_storage<BSIZE> *find_block( mem_addr_t blk_idx ) const
+   {
+      if( blk_idx == m_mru_index ) 
+         return m_mru_block;
+      mem_addr_t dir_idx = blk_idx >> MEM_LEAF_BITS;
+      if( dir_idx >= m_dir.size() || m_dir[dir_idx] == NULL ) 
+         return NULL;
+      return m_dir[dir_idx][blk_idx & (MEM_LEAF_SIZE-1)];
+   }
+   mem_storage<BSIZE> *get_block( mem_addr_t blk_idx );
+
    std::string m_name;
    unsigned m_log2_block_size;
-   typedef mem_map<mem_addr_t,mem_storage<BSIZE> > map_t;
-   map_t m_data;
+   std::vector<mem_storage<BSIZE>**> m_dir;
+   mem_addr_t m_mru_index;
+   mem_storage<BSIZE> *m_mru_block;
+   unsigned char *m_flat;                  // non-NULL when flat backing is in use
+   std::vector<bool> m_flat_touched;       // blocks written in flat mode (for print)
+   mem_touch_observer *m_observer;
    std::map<unsigned,mem_addr_t> m_watchpoints;
 };
 
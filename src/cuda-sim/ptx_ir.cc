@@ -1060,6 +1060,8 @@ ptx_instruction::ptx_instruction( int opcode,
    const std::list<operand_info> checked_operands = check_operands(opcode,scalar_type,operands);
    m_operands.insert(m_operands.begin(), checked_operands.begin(), checked_operands.end() );
    m_return_var = return_var;
+   m_exec_fn = NULL;
+   m_op_classification = 0;
    m_options = options;
    m_wide = false;
    m_hi = false;
@@ -1314,6 +1316,8 @@ function_info::function_info(int entry_point )
    m_kernel_info.smem = 0;
    m_local_mem_framesize = 0;
    m_args_aligned_size = -1;
+   m_dcc_shape_epoch = (unsigned)-1;
+   m_dcc_param_layout = NULL;
 }
 
 unsigned function_info::print_insn( unsigned pc, FILE * fp ) const
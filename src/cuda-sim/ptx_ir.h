@@ -167,6 +167,8 @@ public:
       m_is_func_addr = false;
       m_reg_num_valid = false;
       m_function = NULL;
+      m_reg_slot_func = NULL;
+      m_reg_slot=(unsigned)-1;
       m_reg_num=(unsigned)-1;
       m_arch_reg_num=(unsigned)-1;
       m_address=(unsigned)-1;
@@ -262,6 +264,14 @@ public:
       assert( m_reg_num_valid );
       return m_arch_reg_num; 
    }
+   // index of this register in the call frame of the function that declares it
+   void set_reg_slot( const function_info *func, unsigned slot )
+   {
+      m_reg_slot_func = func;
+      m_reg_slot = slot;
+   }
+   const function_info *reg_slot_func() const { return m_reg_slot_func; }
+   unsigned reg_slot() const { return m_reg_slot; }
    void print_info(FILE *fp) const;
    unsigned uid() const { return m_uid; }
 
@@ -288,6 +298,8 @@ private:
    unsigned m_reg_num; 
    unsigned m_arch_reg_num; 
    bool m_reg_num_valid; 
+   const function_info *m_reg_slot_func;
+   unsigned m_reg_slot;
 
    std::list<operand_info> m_initializer;
    static unsigned sm_next_uid;
@@ -604,7 +616,7 @@ public:
        m_neg_pred=0;
        m_is_return_var=0;
        m_is_non_arch_reg=0;
-
+       m_plain_reg=false;
    }
    void make_memory_operand() { m_type = memory_t;}
    void set_return() { m_is_return_var = true; }
@@ -770,6 +782,14 @@ public:
    addr_t get_const_mem_offset() const { return m_const_mem_offset; }
    bool is_non_arch_reg() const { return m_is_non_arch_reg; }
 
+   // register operand without ptxplus modifiers; resolved once by ptx_instruction::pre_decode()
+   void resolve_plain_reg()
+   {
+      m_plain_reg = is_reg() && !m_vector && m_double_operand_type == 0 && m_operand_lohi == 0 &&
+                    !m_operand_neg && m_addr_space == undefined_space;
+   }
+   bool is_plain_reg() const { return m_plain_reg; }
+
 private:
    unsigned m_uid;
    bool m_valid;
@@ -799,6 +819,7 @@ private:
    bool m_neg_pred;
    bool m_is_return_var;
    bool m_is_non_arch_reg;
+   bool m_plain_reg;
 
    static unsigned sm_next_uid;
    unsigned get_uid();
@@ -849,6 +870,9 @@ struct gpgpu_recon_t {
    class ptx_instruction* target_inst;
 };
 
+// semantic routine of an opcode (one of the *_impl functions listed in opcodes.def)
+typedef void (*ptx_exec_fn_t)( const class ptx_instruction *pI, class ptx_thread_info *thread );
+
 class ptx_instruction : public warp_inst_t {
 public:
     ptx_instruction( int opcode, 
@@ -885,6 +909,9 @@ public:
    unsigned get_num_operands() const { return m_operands.size();}
    bool has_pred() const { return m_pred != NULL;}
    operand_info get_pred() const { return operand_info( m_pred );}
+   const operand_info &pred_operand() const { return m_pred_operand; } // valid after pre_decode()
+   ptx_exec_fn_t exec_fn() const { return m_exec_fn; }
+   int op_classification() const { return m_op_classification; }
    bool get_pred_neg() const { return m_neg_pred;}
    int get_pred_mod() const { return m_pred_mod;}
    const char *get_source() const { return m_source.c_str();}
@@ -1055,6 +1082,9 @@ private:
    const symbol           *m_label;
    std::vector<operand_info> m_operands;
    operand_info m_return_var;
+   operand_info m_pred_operand;
+   ptx_exec_fn_t m_exec_fn;
+   int m_op_classification;
 
    std::list<int>          m_options;
    bool                m_wide;
@@ -1211,11 +1241,34 @@ public:
    {
       m_args.clear();
    }
+   void add_reg_decl( symbol *reg )
+   {
+      assert( reg != NULL );
+      m_reg_decls.push_back(reg);
+   }
+   unsigned num_reg_slots() const
+   {
+      return m_reg_decls.size();
+   }
+   const symbol *get_reg_slot_symbol( unsigned slot ) const
+   {
+      assert( slot < m_reg_decls.size() );
+      return m_reg_decls[slot];
+   }
    unsigned num_args() const
    {
       return m_args.size();
    }
    unsigned get_args_aligned_size();
+   unsigned get_arg_offset( unsigned n )
+   {
+      get_args_aligned_size();
+      std::map<unsigned,param_info>::iterator i = m_ptx_kernel_param_info.find(n);
+      assert( i != m_ptx_kernel_param_info.end() );
+      return i->second.get_offset();
+   }
+   const struct dcc_param_layout_t *get_dcc_param_layout() const { return m_dcc_param_layout; }
+   void set_dcc_param_layout( const struct dcc_param_layout_t *layout ) { m_dcc_param_layout = layout; }
 
    const symbol* get_arg( unsigned n ) const
    {
@@ -1278,6 +1331,23 @@ public:
    }
    bool is_entry_point() const { return m_entry_point; }
 
+   //occupancy profile for a CTA size, maintained by shader_core_config::occupancy()
+   kernel_occupancy_t &occupancy( unsigned threads_per_cta ) const { return m_occupancy[threads_per_cta]; }
+   //DCC: block/kernel size of consolidated child kernels, valid for one configuration epoch
+   bool get_dcc_launch_shape( unsigned epoch, unsigned &threads_per_block, unsigned &threads_per_kernel ) const
+   {
+      if( m_dcc_shape_epoch != epoch ) return false;
+      threads_per_block = m_dcc_threads_per_block;
+      threads_per_kernel = m_dcc_threads_per_kernel;
+      return true;
+   }
+   void set_dcc_launch_shape( unsigned epoch, unsigned threads_per_block, unsigned threads_per_kernel )
+   {
+      m_dcc_shape_epoch = epoch;
+      m_dcc_threads_per_block = threads_per_block;
+      m_dcc_threads_per_kernel = threads_per_kernel;
+   }
+
 private:
    unsigned m_uid;
    unsigned m_local_mem_framesize;
@@ -1290,8 +1360,14 @@ private:
    unsigned m_instr_mem_size;
    std::map<std::string,param_t> m_kernel_params;
    std::map<unsigned,param_info> m_ptx_kernel_param_info;
+   const struct dcc_param_layout_t *m_dcc_param_layout;
+   mutable std::map<unsigned,kernel_occupancy_t> m_occupancy;
+   unsigned m_dcc_shape_epoch;
+   unsigned m_dcc_threads_per_block;
+   unsigned m_dcc_threads_per_kernel;
    const symbol *m_return_var_sym;
    std::vector<const symbol*> m_args;
+   std::vector<symbol*> m_reg_decls; // registers declared in this function, indexed by symbol::reg_slot()
    std::list<ptx_instruction*> m_instructions;
    std::vector<basic_block_t*> m_basic_blocks;
    std::list<std::pair<unsigned, unsigned> > m_back_edges;
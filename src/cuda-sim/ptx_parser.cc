@@ -425,6 +425,8 @@ void add_identifier( const char *identifier, int array_dim, unsigned array_ident
          arch_regnum = 0;
       }
       g_last_symbol->set_regno(regnum, arch_regnum);
+      if( g_current_symbol_table != g_global_symbol_table ) 
+         g_func_info->add_reg_decl(g_last_symbol);
       } break;
    case shared_space:
       printf("GPGPU-Sim PTX: allocating shared region for \"%s\" ",
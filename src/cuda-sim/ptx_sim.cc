@@ -156,8 +156,13 @@ ptx_thread_info::~ptx_thread_info()
 }
 
 ptx_thread_info::ptx_thread_info( kernel_info_t &kernel )
-    : m_kernel(kernel)
 {
+   reset(kernel);
+}
+
+void ptx_thread_info::reset( kernel_info_t &kernel )
+{
+   m_kernel = &kernel;
    m_uid = g_ptx_thread_info_uid_next++;
    m_core = NULL;
    m_barrier_num = -1;
@@ -181,10 +186,16 @@ ptx_thread_info::ptx_thread_info( kernel_info_t &kernel )
    m_hw_sid = -1;
    m_last_dram_callback.function = NULL;
    m_last_dram_callback.instruction = NULL;
-   m_regs.push_back( reg_map_t() );
-   m_debug_trace_regs_modified.push_back( reg_map_t() );
-   m_debug_trace_regs_read.push_back( reg_map_t() );
-   m_callstack.push_back( stack_entry() );
+   m_regs.resize(1);
+   m_regs.front().clear();
+   m_debug_trace_regs_modified.resize(1);
+   m_debug_trace_regs_modified.front().clear();
+   m_debug_trace_regs_read.resize(1);
+   m_debug_trace_regs_read.front().clear();
+   m_callstack.resize(1);
+   m_callstack.front() = stack_entry();
+   while( !m_breakaddrs.empty() ) 
+      m_breakaddrs.pop();
    m_RPC = -1;
    m_RPC_updated = false;
    m_last_was_call = false;
@@ -200,20 +211,20 @@ unsigned long long ptx_thread_info::set_param_mem( unsigned global_tid )
     unsigned long long extra_latency = 0;
    extern bool g_dyn_child_thread_consolidation;
    extern bool g_dcc_kernel_param_onchip;
-   if(g_dyn_child_thread_consolidation && m_kernel.is_child){
-      std::map<unsigned int, class memory_space *>::iterator it;
-      signed int cnt;
-      for( it = m_kernel.m_param_mem_map.begin(), cnt = 0; it != m_kernel.m_param_mem_map.end(); it++, cnt++ ){
-         if (global_tid < it->first )
-	    break;
-      }
+   if(g_dyn_child_thread_consolidation && m_kernel->is_child){
+      // segments are keyed by the first thread id past each merged child, so the
+      // segment owning global_tid is the first end greater than it
+      const std::vector<unsigned int> &seg_end = m_kernel->m_param_seg_end;
+      assert( !seg_end.empty() && seg_end.size() == m_kernel->m_param_mem_map.size() );
+      signed int cnt = std::upper_bound(seg_end.begin(), seg_end.end(), global_tid) - seg_end.begin();
+      signed int n_seg = seg_end.size();
       if(g_dcc_kernel_param_onchip){
-	 if(m_kernel.param_entry_cnt < (signed int)m_kernel.m_param_mem_map.size() - 1 && cnt > m_kernel.param_entry_cnt){
+	 if(m_kernel->param_entry_cnt < n_seg - 1 && cnt > m_kernel->param_entry_cnt){
 	    /* change param entry 
 	     * --> old param entry is freed
 	     * --> reclaim param buffer usage and turn-off full bit if occupance < 50% 
 	     **/
-	    m_kernel.param_entry_cnt = cnt;
+	    m_kernel->param_entry_cnt = cnt;
 	    extern signed kernel_param_usage;
 	    extern signed long long param_buffer_usage;
 	    extern unsigned g_max_param_buffer_size;
@@ -229,23 +240,14 @@ unsigned long long ptx_thread_info::set_param_mem( unsigned global_tid )
 	    fprintf(stdout, "\n");
 	 }
       }
-      if( it == m_kernel.m_param_mem_map.end() )
-         it = m_kernel.m_param_mem_map.begin();
-      m_param_mem = it->second;
+      m_param_mem = m_kernel->m_param_seg_mem[ (cnt == n_seg)? 0 : cnt ];
 
       // correct timing simulation on kernel parameters
-      std::map<unsigned int, addr_t>::iterator it2;
-      for( it2 = m_kernel.m_param_mem_base_map.begin(); it2 != m_kernel.m_param_mem_base_map.end(); it2++){
-	 if (global_tid < it2->first) break;
-      }
-      if( it2 == m_kernel.m_param_mem_base_map.end() )
-	 it2--;
-      m_param_memory_base = it2->second;
+      m_param_memory_base = m_kernel->m_param_seg_base[ (cnt == n_seg)? n_seg - 1 : cnt ];
 
       extern bool g_estimate_offchip_metadata_load_latency;
-      std::map<unsigned int, int>::iterator it3;
-      for( it3 = m_kernel.m_kernel_queue_entry_map.begin(); it3 != m_kernel.m_kernel_queue_entry_map.end(); it3++){
-	  if(global_tid == it3->first ){ //first thread of a new metadata
+      std::map<unsigned int, int>::iterator it3 = m_kernel->m_kernel_queue_entry_map.find(global_tid);
+      if( it3 != m_kernel->m_kernel_queue_entry_map.end() ){ //first thread of a new metadata
 //	      extern unsigned int block_scheduling_delay;
 	      extern unsigned int AVG_PARAM_RD_TIME;
 //	      extern unsigned int num_offchip_metadata;
@@ -263,10 +265,9 @@ unsigned long long ptx_thread_info::set_param_mem( unsigned global_tid )
 		  }
 	      }
 #endif
-	  }
 #if 0
 	  if( (global_tid == it3->first - 1) || 
-		  ((it3->first > m_kernel.num_blocks() * m_kernel.threads_per_cta()) && global_tid == (m_kernel.num_blocks() * m_kernel.threads_per_cta() - 1)) ){
+		  ((it3->first > m_kernel->num_blocks() * m_kernel->threads_per_cta()) && global_tid == (m_kernel->num_blocks() * m_kernel->threads_per_cta() - 1)) ){
 	      //last thread of the current metadata
 	      extern bool *g_kernel_queue_entry_empty;
 	      extern unsigned int g_kernel_queue_entry_used;
@@ -286,9 +287,9 @@ unsigned long long ptx_thread_info::set_param_mem( unsigned global_tid )
       }
    } else {
       //bddream - DKPL
-      m_param_mem = m_kernel.get_param_memory(m_agg_group_id); 
+      m_param_mem = m_kernel->get_param_memory(m_agg_group_id); 
       // correct timing simulation on kernel parameters
-      m_param_memory_base = m_kernel.get_param_memory_base(m_agg_group_id);
+      m_param_memory_base = m_kernel->get_param_memory_base(m_agg_group_id);
    }
 
    return extra_latency;
@@ -463,6 +464,17 @@ static void print_reg( FILE *fp, std::string name, ptx_reg_t value, symbol_table
    fflush(fp);
 }
 
+void reg_frame_t::get_contents( std::vector< std::pair<const symbol*,ptx_reg_t> > &contents ) const
+{
+   for( unsigned slot=0; slot < m_valid.size(); slot++ ) {
+      if( m_valid[slot] ) 
+         contents.push_back( std::make_pair(m_func->get_reg_slot_symbol(slot),m_values[slot]) );
+   }
+   reg_map_t::const_iterator r;
+   for( r=m_other.begin(); r != m_other.end(); ++r ) 
+      contents.push_back( *r );
+}
+
 static void print_reg( std::string name, ptx_reg_t value, symbol_table *symtab )
 {
    print_reg(stdout,name,value,symtab);
@@ -475,7 +487,7 @@ void ptx_thread_info::callstack_push( unsigned pc, unsigned rpc, const symbol *r
    m_last_was_call = true;
    assert( m_func_info != NULL );
    m_callstack.push_back( stack_entry(m_symbol_table,m_func_info,pc,rpc,return_var_src,return_var_dst,call_uid) );
-   m_regs.push_back( reg_map_t() );
+   m_regs.push_back( reg_frame_t() );
    m_debug_trace_regs_modified.push_back( reg_map_t() );
    m_debug_trace_regs_read.push_back( reg_map_t() );
    m_local_mem_stack_pointer += m_func_info->local_mem_framesize(); 
@@ -489,7 +501,7 @@ void ptx_thread_info::callstack_push_plus( unsigned pc, unsigned rpc, const symb
    m_last_was_call = true;
    assert( m_func_info != NULL );
    m_callstack.push_back( stack_entry(m_symbol_table,m_func_info,pc,rpc,return_var_src,return_var_dst,call_uid) );
-   //m_regs.push_back( reg_map_t() );
+   //m_regs.push_back( reg_frame_t() );
    //m_debug_trace_regs_modified.push_back( reg_map_t() );
    //m_debug_trace_regs_read.push_back( reg_map_t() );
    m_local_mem_stack_pointer += m_func_info->local_mem_framesize();
@@ -566,13 +578,13 @@ bool ptx_thread_info::callstack_pop_plus()
 void ptx_thread_info::dump_callstack() const
 {
    std::list<stack_entry>::const_iterator c=m_callstack.begin();
-   std::list<reg_map_t>::const_iterator r=m_regs.begin();
+   std::list<reg_frame_t>::const_iterator r=m_regs.begin();
 
    printf("\n\n");
    printf("Call stack for thread uid = %u (sc=%u, hwtid=%u)\n", m_uid, m_hw_sid, m_hw_tid );
    while( c != m_callstack.end() && r != m_regs.end() ) {
       const stack_entry &c_e = *c;
-      const reg_map_t &regs = *r;
+      const reg_frame_t &regs = *r;
       if( !c_e.m_valid ) {
          printf("  <entry>                              #regs = %zu\n", regs.size() );
       } else {
@@ -615,8 +627,10 @@ void ptx_thread_info::dump_regs( FILE *fp )
    if(m_regs.back().empty()) return;
    fprintf(fp,"Register File Contents:\n");
    fflush(fp);
-   reg_map_t::const_iterator r;
-   for ( r=m_regs.back().begin(); r != m_regs.back().end(); ++r ) {
+   std::vector< std::pair<const symbol*,ptx_reg_t> > contents;
+   m_regs.back().get_contents(contents);
+   std::vector< std::pair<const symbol*,ptx_reg_t> >::const_iterator r;
+   for ( r=contents.begin(); r != contents.end(); ++r ) {
       const symbol *sym = r->first;
       ptx_reg_t value = r->second;
       std::string name = sym->name();
@@ -173,6 +173,43 @@ class ptx_cta_info {
 
 class symbol;
 
+// Register values of one call frame.  Registers declared by the function that
+// owns the frame live in a flat array indexed by symbol::reg_slot(); the frame
+// is bound to its function on first access.  Registers of any other function
+// fall back to a per-symbol map, so lookups behave as a single map would.
+class reg_frame_t {
+	public:
+		reg_frame_t() 
+		{
+			m_func = NULL;
+			m_num_valid = 0;
+		}
+		ptx_reg_t *find( const symbol *reg ); // NULL if the register was never written
+		ptx_reg_t &operator[]( const symbol *reg );
+		size_t size() const { return m_num_valid + m_other.size(); }
+		bool empty() const { return size() == 0; }
+		// forget every register and the bound function, keeping the storage
+		void clear()
+		{
+			m_func = NULL;
+			m_num_valid = 0;
+			m_valid.assign( m_valid.size(), false );
+			m_other.clear();
+		}
+		void get_contents( std::vector< std::pair<const symbol*,ptx_reg_t> > &contents ) const;
+
+	private:
+		void bind( const function_info *func );
+
+		typedef tr1_hash_map<const symbol*,ptx_reg_t> reg_map_t;
+
+		const function_info *m_func;
+		std::vector<ptx_reg_t> m_values;
+		std::vector<bool> m_valid;
+		unsigned m_num_valid;
+		reg_map_t m_other;
+};
+
 struct stack_entry {
 	stack_entry() {
 		m_symbol_table=NULL;
@@ -265,6 +302,9 @@ class ptx_thread_info {
 	public:
 		~ptx_thread_info();
 		ptx_thread_info( kernel_info_t &kernel );
+		// return a finished thread to the freshly constructed state for a
+		// thread of kernel, reusing its register frame and call stack storage
+		void reset( kernel_info_t &kernel );
 
 		void init(gpgpu_t *gpu, core_t *core, unsigned sid, unsigned cta_id, unsigned wid, unsigned tid, bool fsim) 
 		{ 
@@ -283,7 +323,7 @@ class ptx_thread_info {
 		const ptx_version &get_ptx_version() const;
 		void set_reg( const symbol *reg, const ptx_reg_t &value );
 		ptx_reg_t get_reg( const symbol *reg );
-		ptx_reg_t get_operand_value( const operand_info &op, operand_info dstInfo, unsigned opType, ptx_thread_info *thread, int derefFlag );
+		ptx_reg_t get_operand_value( const operand_info &op, const operand_info &dstInfo, unsigned opType, ptx_thread_info *thread, int derefFlag );
 		void set_operand_value( const operand_info &dst, const ptx_reg_t &data, unsigned type, ptx_thread_info *thread, const ptx_instruction *pI, int shfl_pval = 0 );
 		void set_operand_value( const operand_info &dst, const ptx_reg_t &data, unsigned type, ptx_thread_info *thread, const ptx_instruction *pI, int overflow, int carry );
 		void get_vector_operand_values( const operand_info &op, ptx_reg_t* ptx_regs, unsigned num_elements );
@@ -411,7 +451,7 @@ class ptx_thread_info {
 		void clear_modifiedregs() { m_debug_trace_regs_modified.back().clear(); m_debug_trace_regs_read.back().clear(); }
 		function_info *get_finfo() { return m_func_info;   }
 		//Andrew
-   		kernel_info_t &get_kernel_info(){return m_kernel;} ;
+   		kernel_info_t &get_kernel_info(){return *m_kernel;} ;
 		const function_info *get_finfo() const { return m_func_info;   }
 		void push_breakaddr(const operand_info &breakaddr);
 		const operand_info& pop_breakaddr();
@@ -444,7 +484,7 @@ class ptx_thread_info {
 		//void set_param_mem(unsigned global_tid);
 		addr_t m_param_memory_base;
 		//Jin: get corresponding kernel grid for CDP purpose
-		kernel_info_t & get_kernel() { return m_kernel; }
+		kernel_info_t & get_kernel() { return *m_kernel; }
 
 	public:
 		addr_t         m_last_effective_address;
@@ -457,7 +497,7 @@ class ptx_thread_info {
 		ptx_reg_t m_last_set_operand_value;
 		
 		//Andrew
-		kernel_info_t &m_kernel;
+		kernel_info_t *m_kernel;
 		unsigned m_kernel_id;
 		unsigned m_hw_sid;
 		unsigned m_hw_tid;
@@ -501,7 +541,7 @@ class ptx_thread_info {
 		unsigned m_local_mem_stack_pointer;
 
 		typedef tr1_hash_map<const symbol*,ptx_reg_t> reg_map_t;
-		std::list<reg_map_t> m_regs;
+		std::list<reg_frame_t> m_regs;
 		std::list<reg_map_t> m_debug_trace_regs_modified;
 		std::list<reg_map_t> m_debug_trace_regs_read;
 		bool m_enable_debug_trace;
@@ -531,5 +571,10 @@ bool isspace_child_param( addr_t addr );
 memory_space_t whichspace( addr_t addr );
 
 extern unsigned g_ptx_thread_info_uid_next;
+extern unsigned g_ptx_thread_info_delete_count;
+
+// conversion routines indexed by [source type][destination type], defined in instructions.cc
+extern ptx_reg_t (*g_cvt_fn[11][11])( ptx_reg_t x, unsigned from_width, unsigned to_width, int to_sign, 
+                                      int rounding_mode, int saturation_mode );
 
 #endif
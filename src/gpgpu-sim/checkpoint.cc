@@ -0,0 +1,162 @@
+#include "checkpoint.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gpu-sim.h"
+#include "../abstract_hardware_model.h"
+
+#define CHECKPOINT_MAGIC 0x54504b43 // "CKPT"
+#define CHECKPOINT_VERSION 2
+
+sim_checkpoint::sim_checkpoint( gpgpu_sim *gpu, unsigned long long at_cycle, const char *save_file, const char *restore_file )
+   : m_gpu(gpu), m_at_cycle(at_cycle), m_save_file(NULL), m_restore_fp(NULL),
+     m_n_boundaries(0), m_restore_boundary(0), m_next_read(0), m_next_byte(0)
+{
+   if( at_cycle )
+      m_save_file = save_file;
+   if( restore_file == NULL || restore_file[0] == 0 )
+      return;
+
+   m_restore_fp = fopen(restore_file, "rb");
+   if( m_restore_fp == NULL ) {
+      printf("GPGPU-Sim: ERROR cannot open checkpoint \'%s\'\n", restore_file);
+      abort();
+   }
+   unsigned header[3];
+   unsigned n_reads = 0;
+   bool ok = fread(header, sizeof(header), 1, m_restore_fp) == 1
+          && header[0] == CHECKPOINT_MAGIC && header[1] == CHECKPOINT_VERSION
+          && fread(&n_reads, sizeof(n_reads), 1, m_restore_fp) == 1;
+   if( ok ) {
+      m_restore_boundary = header[2];
+      m_read_size.resize(n_reads);
+      ok = n_reads == 0 || fread(&m_read_size[0], sizeof(size_t), n_reads, m_restore_fp) == n_reads;
+      size_t n_bytes = 0;
+      for( unsigned r=0; ok && r < n_reads; r++ )
+         n_bytes += m_read_size[r];
+      m_read_data.resize(n_bytes);
+      ok = ok && (n_bytes == 0 || fread(&m_read_data[0], 1, n_bytes, m_restore_fp) == n_bytes);
+      std::vector<unsigned> uids(m_restore_boundary);
+      ok = ok && (m_restore_boundary == 0 || fread(&uids[0], sizeof(unsigned), m_restore_boundary, m_restore_fp) == m_restore_boundary);
+      m_restore_uids.insert(uids.begin(), uids.end());
+      ok = ok && m_restore_uids.size() == m_restore_boundary;
+   }
+   if( !ok ) {
+      printf("GPGPU-Sim: ERROR \'%s\' is not a valid checkpoint\n", restore_file);
+      abort();
+   }
+   printf("GPGPU-Sim: restoring checkpoint \'%s\' at host kernel boundary %u (%u host reads)\n",
+          restore_file, m_restore_boundary, n_reads);
+}
+
+bool sim_checkpoint::host_kernel_boundary( kernel_info_t *kernel )
+{
+   // a kernel may wait at the front of its stream for many cycles, and with
+   // several streams it comes back after other streams' kernels were looked at
+   unsigned uid = kernel->get_uid();
+   if( !m_seen_uids.insert(uid).second )
+      return false;
+   unsigned boundary = m_n_boundaries++;
+
+   if( m_restore_fp ) {
+      if( m_restore_uids.erase(uid) ) {
+         m_boundary_uids.push_back(uid);
+         return true;
+      }
+      if( !m_restore_uids.empty() ) {
+         printf("GPGPU-Sim: ERROR host program diverged from the restored checkpoint (kernel %u reached boundary %u, %zu kernels of the checkpoint not launched yet)\n",
+                uid, boundary, m_restore_uids.size());
+         abort();
+      }
+      assert( boundary == m_restore_boundary );
+      restore();
+   }
+   if( m_save_file && gpu_sim_cycle + gpu_tot_sim_cycle >= m_at_cycle && !m_gpu->active() )
+      save(boundary);
+   m_boundary_uids.push_back(uid);
+   return false;
+}
+
+bool sim_checkpoint::replay_host_read( void *dst, size_t count )
+{
+   if( m_restore_fp == NULL )
+      return false;
+   if( m_next_read >= m_read_size.size() || m_read_size[m_next_read] != count ) {
+      printf("GPGPU-Sim: ERROR host program diverged from the restored checkpoint (device-to-host copy %u of %zu bytes)\n",
+             m_next_read, count);
+      abort();
+   }
+   memcpy(dst, &m_read_data[m_next_byte], count);
+   m_next_read++;
+   m_next_byte += count;
+   return true;
+}
+
+void sim_checkpoint::record_host_read( const void *src, size_t count )
+{
+   if( m_save_file == NULL )
+      return;
+   if( m_restore_fp == NULL ) {
+      // replayed reads are already in the log
+      m_read_size.push_back(count);
+      m_read_data.insert(m_read_data.end(), (const unsigned char*)src, (const unsigned char*)src + count);
+   }
+}
+
+void sim_checkpoint::save( unsigned boundary )
+{
+   FILE *fp = fopen(m_save_file, "wb");
+   if( fp == NULL ) {
+      printf("GPGPU-Sim: ERROR cannot write checkpoint \'%s\'\n", m_save_file);
+      abort();
+   }
+   unsigned header[3] = { CHECKPOINT_MAGIC, CHECKPOINT_VERSION, boundary };
+   unsigned n_reads = m_read_size.size();
+   fwrite(header, sizeof(header), 1, fp);
+   fwrite(&n_reads, sizeof(n_reads), 1, fp);
+   if( n_reads ) {
+      fwrite(&m_read_size[0], sizeof(size_t), n_reads, fp);
+      if( !m_read_data.empty() )
+         fwrite(&m_read_data[0], 1, m_read_data.size(), fp);
+   }
+   assert( m_boundary_uids.size() == boundary );
+   if( boundary )
+      fwrite(&m_boundary_uids[0], sizeof(unsigned), boundary, fp);
+   m_gpu->save_state(fp);
+   bool ok = !ferror(fp);
+   fclose(fp);
+   if( !ok ) {
+      printf("GPGPU-Sim: ERROR writing checkpoint \'%s\' failed\n", m_save_file);
+      abort();
+   }
+   printf("GPGPU-Sim: checkpoint \'%s\' written at cycle %llu (host kernel boundary %u)\n",
+          m_save_file, gpu_sim_cycle + gpu_tot_sim_cycle, boundary);
+   fflush(stdout);
+
+   m_save_file = NULL;
+   m_read_size.clear();
+   m_read_data.clear();
+}
+
+void sim_checkpoint::restore()
+{
+   if( m_next_read != m_read_size.size() ) {
+      printf("GPGPU-Sim: ERROR host program diverged from the restored checkpoint (%u of %zu device-to-host copies replayed)\n",
+             m_next_read, m_read_size.size());
+      abort();
+   }
+   if( !m_gpu->load_state(m_restore_fp) ) {
+      printf("GPGPU-Sim: ERROR checkpoint is truncated or was taken with a different configuration\n");
+      abort();
+   }
+   fclose(m_restore_fp);
+   m_restore_fp = NULL;
+   printf("GPGPU-Sim: checkpoint restored, resuming at cycle %llu\n", gpu_sim_cycle + gpu_tot_sim_cycle);
+   fflush(stdout);
+   if( m_save_file == NULL ) {
+      m_read_size.clear();
+      m_read_data.clear();
+   }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdio.h>
+#include <set>
+#include <vector>
+
+class gpgpu_sim;
+class kernel_info_t;
+
+// Warm-start checkpoint of a simulation, taken at the first boundary between
+// host-launched kernels at or after a given cycle at which the GPU is drained.
+// Nothing is in flight at such a boundary, so the architectural state that
+// carries over (global memory, allocators, L2 tags, cumulative counters) is
+// enough to continue.  A restored run re-executes the host program: kernels
+// before the boundary are dropped and device-to-host copies are answered from
+// the log stored in the checkpoint, so the host program must be deterministic.
+// The checkpoint also lists the uids of the dropped kernels; a restored run
+// aborts if a kernel outside that list reaches a boundary before all of them.
+class sim_checkpoint
+{
+public:
+   sim_checkpoint( gpgpu_sim *gpu, unsigned long long at_cycle, const char *save_file, const char *restore_file );
+
+   // called while a host-launched kernel is at the front of its stream;
+   // returns true if the kernel ran before the restored checkpoint and must be dropped
+   bool host_kernel_boundary( class kernel_info_t *kernel );
+
+   // device-to-host copies
+   bool replay_host_read( void *dst, size_t count );
+   void record_host_read( const void *src, size_t count );
+
+private:
+   void save( unsigned boundary );
+   void restore();
+
+   gpgpu_sim *m_gpu;
+   unsigned long long m_at_cycle;
+   const char *m_save_file;   // NULL once written (or if not requested)
+   FILE *m_restore_fp;        // open until the state has been loaded
+
+   std::set<unsigned> m_seen_uids;          // host kernels already counted as a boundary
+   std::vector<unsigned> m_boundary_uids;   // the same kernels in boundary order
+   unsigned m_n_boundaries;
+   unsigned m_restore_boundary;
+   std::set<unsigned> m_restore_uids;       // kernels before the restored boundary not yet dropped
+
+   // host read log; m_next_read indexes the next read to replay
+   std::vector<size_t> m_read_size;
+   std::vector<unsigned char> m_read_data;
+   unsigned m_next_read;
+   size_t m_next_byte;
+};
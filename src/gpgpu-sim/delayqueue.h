@@ -161,6 +161,13 @@ public:
    }
 
    bool full() const { return (m_max_len && m_length >= m_max_len); }
+   // true if every entry is a NULL inserted to model delay
+   bool drained() const
+   {
+      for (fifo_data<T> *ddp = m_head; ddp; ddp = ddp->m_next) 
+         if (ddp->m_data) return false;
+      return true;
+   }
    bool empty() const { return m_head == NULL; }
    unsigned get_n_element() const { return m_n_element; }
    unsigned get_length() const { return m_length; }
@@ -420,6 +420,37 @@ void dram_t::cycle()
 #endif
 }
 
+// true if cycle() has no request to move and every timing constraint has
+// expired, so it only counts a NOP and an idle cycle on each bank
+bool dram_t::quiescent() const
+{
+   if (que_length() || !mrqq->empty() || !returnq->empty() || !rwq->drained())
+      return false;
+   if (RRDc || CCDc || RTWc || WTRc)
+      return false;
+   for (unsigned j=0;j<m_config->nbk;j++) {
+      if (bk[j]->mrq || bk[j]->RCDc || bk[j]->RASc || bk[j]->RCc || bk[j]->RPc 
+          || bk[j]->RCDWRc || bk[j]->WTPc || bk[j]->RTPc)
+         return false;
+   }
+   for (unsigned j=0; j<m_config->nbkgrp; j++) {
+      if (bkgrp[j]->CCDLc || bkgrp[j]->RTPLc)
+         return false;
+   }
+   return true;
+}
+
+// n calls to cycle() while quiescent()
+void dram_t::idle_cycle( unsigned n )
+{
+   for (unsigned j=0;j<m_config->nbk;j++) 
+      bk[j]->n_idle += n;
+   n_nop += n;
+   n_nop_partial += n;
+   n_cmd += n;
+   n_cmd_partial += n;
+}
+
 //if mrq is being serviced by dram, gets popped after CL latency fulfilled
 class mem_fetch* dram_t::return_queue_pop() 
 {
@@ -109,6 +109,8 @@ public:
    class mem_fetch* return_queue_top();
    void push( class mem_fetch *data );
    void cycle();
+   bool quiescent() const;
+   void idle_cycle( unsigned n );
    void dram_log (int task);
 
    class memory_partition_unit *m_memory_partition_unit;
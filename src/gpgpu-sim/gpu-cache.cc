@@ -283,6 +283,33 @@ void tag_array::flush()
         m_lines[i].m_status = INVALID;
 }
 
+void tag_array::warm( new_addr_type addr, unsigned time )
+{
+    unsigned idx;
+    enum cache_request_status status = probe(addr,idx);
+    if (status == HIT || status == HIT_RESERVED) {
+        m_lines[idx].m_last_access_time = time;
+    } else if (status == MISS) {
+        m_lines[idx].allocate( m_config.tag(addr), m_config.block_addr(addr), time );
+        m_lines[idx].fill(time);
+    }
+}
+
+void tag_array::save_state( FILE *fp ) const
+{
+    unsigned n_lines = size();
+    fwrite(&n_lines, sizeof(n_lines), 1, fp);
+    fwrite(m_lines, sizeof(cache_block_t), n_lines, fp);
+}
+
+bool tag_array::load_state( FILE *fp )
+{
+    unsigned n_lines;
+    if (fread(&n_lines, sizeof(n_lines), 1, fp) != 1 || n_lines != size())
+        return false; // saved with a different cache geometry
+    return fread(m_lines, sizeof(cache_block_t), n_lines, fp) == n_lines;
+}
+
 float tag_array::windowed_miss_rate( ) const
 {
     unsigned n_access    = m_access - m_prev_snapshot_access;
@@ -612,6 +639,12 @@ void cache_stats::sample_cache_port_utility(bool data_port_busy, bool fill_port_
     } 
 }
 
+/// n samples of sample_cache_port_utility(false, false)
+void cache_stats::sample_idle_cache_port(unsigned n) 
+{
+    m_cache_port_available_cycles += n; 
+}
+
 baseline_cache::bandwidth_management::bandwidth_management(cache_config &config) 
 : m_config(config)
 {
@@ -353,6 +353,13 @@ public:
     void flush(); // flash invalidate all entries
     void new_window();
 
+    // install a line without counting an access (sampled simulation warm-up)
+    void warm( new_addr_type addr, unsigned time );
+
+    // raw copy of the lines for simulation checkpoints
+    void save_state( FILE *fp ) const;
+    bool load_state( FILE *fp );
+
     void print( FILE *stream, unsigned &total_access, unsigned &total_misses ) const;
     float windowed_miss_rate( ) const;
     void get_stats(unsigned &total_access, unsigned &total_misses, unsigned &total_hit_res, unsigned &total_res_fail) const;
@@ -522,6 +529,7 @@ public:
     void get_sub_stats(struct cache_sub_stats &css) const;
 
     void sample_cache_port_utility(bool data_port_busy, bool fill_port_busy); 
+    void sample_idle_cache_port(unsigned n); 
 private:
 //    inline bool check_valid(int type, int status) const;
     inline bool check_valid(int type, int status) const{
@@ -604,6 +612,16 @@ public:
     mem_fetch *next_access(){return m_mshrs.next_access();}
     // flash invalidate all entries in cache
     void flush(){m_tag_array->flush();}
+    void warm( new_addr_type addr, unsigned time ) { m_tag_array->warm(addr, time); }
+    void save_tags( FILE *fp ) const { m_tag_array->save_state(fp); }
+    bool load_tags( FILE *fp ) { return m_tag_array->load_state(fp); }
+    /// True if cycle() has nothing to do besides sampling the (free) ports
+    bool quiescent() const {
+        return m_miss_queue.empty() && m_extra_mf_fields.empty() && !m_mshrs.access_ready()
+            && data_port_free() && fill_port_free();
+    }
+    /// Equivalent of n calls to cycle() on a quiescent cache
+    void idle_cycle( unsigned n = 1 ) { m_stats.sample_idle_cache_port(n); }
     void print(FILE *fp, unsigned &accesses, unsigned &misses) const;
     void display_state( FILE *fp ) const;
 
@@ -1021,6 +1039,11 @@ public:
     void fill( mem_fetch *mf, unsigned time );
     /// Are any (accepted) accesses that had to wait for memory now ready? (does not include accesses that "HIT")
     bool access_ready() const{return !m_result_fifo.empty();}
+    /// True if cycle() has nothing to do (tex_cache::cycle() collects no stats)
+    bool quiescent() const {
+        return m_request_fifo.empty() && m_fragment_fifo.empty() && m_rob.empty()
+            && m_result_fifo.empty() && m_extra_mf_fields.empty();
+    }
     /// Pop next ready access (includes both accesses that "HIT" and those that "MISS")
     mem_fetch *next_access(){return m_result_fifo.pop();}
     void display_state( FILE *fp ) const;
@@ -49,6 +49,9 @@
 #include "addrdec.h"
 #include "stat-tool.h"
 #include "l2cache.h"
+#include "checkpoint.h"
+#include "sampler.h"
+#include "memoizer.h"
 
 #include "../cuda-sim/ptx-stats.h"
 #include "../statwrapper.h"
@@ -363,6 +366,9 @@ void shader_core_config::reg_options(class OptionParser * opp)
 	option_parser_register(opp, "-gpgpu_operand_collector_num_out_ports_gen", OPT_INT32, &gpgpu_operand_collector_num_out_ports_gen,
 			"number of collector unit in ports (default = 0)", 
 			"0");
+	option_parser_register(opp, "-gpgpu_operand_collector_legacy_arbiter", OPT_BOOL, &gpgpu_operand_collector_legacy_arbiter,
+			"use the previous full-matrix bank arbiter and dispatch scan of the operand collector, for comparison (default = 0)", 
+			"0");
 	option_parser_register(opp, "-gpgpu_coalesce_arch", OPT_INT32, &gpgpu_coalesce_arch, 
 			"Coalescing arch (default = 13, anything else is off for now)", 
 			"13");
@@ -375,6 +381,9 @@ void shader_core_config::reg_options(class OptionParser * opp)
 	option_parser_register(opp, "-gpgpu_simt_core_sim_order", OPT_INT32, &simt_core_sim_order,
 			"Select the simulation order of cores in a cluster (0=Fix, 1=Round-Robin)",
 			"1");
+	option_parser_register(opp, "-gpgpu_core_sleep", OPT_BOOL, &gpgpu_core_sleep,
+			"Skip the pipeline of SIMT cores that have nothing to do until a CTA or memory response arrives",
+			"0");
 	option_parser_register(opp, "-gpgpu_pipeline_widths", OPT_CSTR, &pipeline_widths_string,
 			"Pipeline widths "
 			"ID_OC_SP,ID_OC_SFU,ID_OC_MEM,OC_EX_SP,OC_EX_SFU,OC_EX_MEM,EX_WB",
@@ -427,6 +436,30 @@ void gpgpu_sim_config::reg_options(option_parser_t opp)
 	option_parser_register(opp, "-gpgpu_flush_l2_cache", OPT_BOOL, &gpgpu_flush_l2_cache,
 			"Flush L2 cache at the end of each kernel call",
 			"0");
+	option_parser_register(opp, "-gpgpu_idle_fast_forward", OPT_BOOL, &gpgpu_idle_fast_forward,
+			"Jump over cycles in which only kernel launch latency, block scheduling delay or the busy kernel consolidation engine is pending (requires -gpgpu_core_sleep 1, rejected otherwise)",
+			"0");
+	option_parser_register(opp, "-checkpoint_at_cycle", OPT_INT64, &checkpoint_at_cycle,
+			"Write a checkpoint at the first drained host kernel boundary at or after this cycle (0 = off)",
+			"0");
+	option_parser_register(opp, "-checkpoint_file", OPT_CSTR, &checkpoint_file,
+			"File written by -checkpoint_at_cycle",
+			"gpgpusim.ckpt");
+	option_parser_register(opp, "-restore_checkpoint", OPT_CSTR, &restore_checkpoint,
+			"Resume from this checkpoint file (empty = off)",
+			"");
+	option_parser_register(opp, "-sampling_period", OPT_UINT32, &sampling_period,
+			"Sampled simulation: number of host kernels per sampling period (0 = off, every kernel in detail)",
+			"0");
+	option_parser_register(opp, "-sampling_detailed", OPT_UINT32, &sampling_detailed,
+			"Sampled simulation: host kernels simulated in detail at the start of each period, the rest are fast-forwarded functionally",
+			"1");
+	option_parser_register(opp, "-sampling_warm_l2", OPT_BOOL, &sampling_warm_l2,
+			"Sampled simulation: update the L2 tags with the global accesses of fast-forwarded kernels",
+			"1");
+	option_parser_register(opp, "-gpgpu_memoize_kernels", OPT_BOOL, &gpgpu_memoize_kernels,
+			"Replay repeated host kernel launches with identical parameters and inputs instead of simulating them (ignored with -sampling_period)",
+			"0");
 
 	option_parser_register(opp, "-gpgpu_deadlock_detect", OPT_BOOL, &gpu_deadlock_detect, 
 			"Stop the simulation at deadlock (1=on (default), 0=off)", 
@@ -475,6 +508,9 @@ void gpgpu_sim_config::reg_options(option_parser_t opp)
 	option_parser_register(opp, "-agg_blocks_support", OPT_BOOL, 
 			&g_agg_blocks_support, "Turn on aggregated blocks support, Default: false",
 			"0");
+	option_parser_register(opp, "-cdp_warp_launch_batching", OPT_BOOL, 
+			&g_cdp_warp_launch_batching, "Merge the device launches of a warp to the same child function into one child kernel (CDP only), Default: false",
+			"0");
 	//Jin: kernel launch latency
 	extern unsigned g_kernel_launch_latency;
 	option_parser_register(opp, "-gpgpu_kernel_launch_latency", OPT_INT32, 
@@ -515,6 +551,10 @@ void gpgpu_sim_config::reg_options(option_parser_t opp)
 	option_parser_register(opp, "-application_name", OPT_INT32,
 			&g_app_name, "Test application id. Default: 0",
 			"0");
+	extern char *g_dcc_param_layout_file;
+	option_parser_register(opp, "-dcc_param_layout_file", OPT_CSTR,
+			&g_dcc_param_layout_file, "Child kernel parameter layouts for consolidation (overrides -application_name per kernel)",
+			"");
 	
 	extern int g_global_constant_pointer_sharing;
 	option_parser_register(opp, "-global_constant_pointer_sharing", OPT_INT32,
@@ -546,6 +586,15 @@ void gpgpu_sim_config::reg_options(option_parser_t opp)
 			&g_estimate_offchip_metadata_load_latency, "Estimate the latency of accessing kernel metadata in global memory, Default: true",
 			"1");
 
+	extern char *g_dcc_consolidation_policy;
+	option_parser_register(opp, "-dcc_consolidation_policy", OPT_CSTR,
+			&g_dcc_consolidation_policy, "Child kernel consolidation policy: threshold, timeout, occupancy or warp. Default: threshold",
+			"threshold");
+
+	option_parser_register(opp, "-dcc_timeout_threshold", OPT_UINT32,
+			&g_dcc_timeout_threshold, "Cycles a child kernel may wait before the timeout consolidation policy issues it. Default: 200",
+			"200");
+
 	extern bool g_child_aware_smk_scheduling;
 	option_parser_register(opp, "-child_aware_SMK_scheduling", OPT_BOOL,
 			&g_child_aware_smk_scheduling, "Enable child kernel aware block/warp SMK scheduling, Default: false",
@@ -611,20 +660,24 @@ void gpgpu_sim::launch( kernel_info_t *kinfo )
 		printf("                 modify the CUDA source to decrease the kernel block size.\n");
 		abort();
 	}
-	unsigned n=0;
-	for(n=0; n < m_running_kernels.size(); n++ ) {
-		if( (NULL==m_running_kernels[n]) || m_running_kernels[n]->done() ) {
-			m_running_kernels[n] = kinfo;
-#if 0
-			/* DCC: give child higher priority to reduce the size of parameter buffer*/
-			if(g_dyn_child_thread_consolidation && kinfo->is_child){
-			   fprintf(stdout, "DCC: give child higher priority to reduce the size of param buffer\n");
-			   m_last_issued_kernel = n;
-                        }
-#endif
+	// lowest slot that is empty or holds a kernel that is done
+	unsigned n=m_running_slots.first_clear();
+	for(int s=next_running_slot(0); s >= 0 && (unsigned)s < n; s=next_running_slot(s+1) ) {
+		if( m_running_kernels[s]->done() ) {
+			n = s;
 			break;
 		}
 	}
+	if( n < m_running_kernels.size() ) {
+		set_running_slot(n, kinfo);
+#if 0
+		/* DCC: give child higher priority to reduce the size of parameter buffer*/
+		if(g_dyn_child_thread_consolidation && kinfo->is_child){
+		   fprintf(stdout, "DCC: give child higher priority to reduce the size of param buffer\n");
+		   m_last_issued_kernel = n;
+		}
+#endif
+	}
 	kinfo->per_SM_block_cnt = new unsigned*[m_config.num_shader()];
 	for( unsigned i = 0; i < m_config.num_shader(); i++){
 	   kinfo->per_SM_block_cnt[i] = new unsigned[m_shader_config->n_simt_cores_per_cluster];
@@ -638,10 +691,10 @@ void gpgpu_sim::launch( kernel_info_t *kinfo )
 
 unsigned gpgpu_sim::can_start_kernel()
 {
-    unsigned cnt = 0;
+    unsigned cnt = m_running_kernels.size() - m_n_running_slots;
 
-	for(unsigned n=0; n < m_running_kernels.size(); n++ ) {
-		if( (NULL==m_running_kernels[n]) || m_running_kernels[n]->done() ) 
+	for(int n=next_running_slot(0); n >= 0; n=next_running_slot(n+1) ) {
+		if( m_running_kernels[n]->done() ) 
 		    cnt++;
 //			return true;
 	}
@@ -655,24 +708,49 @@ bool gpgpu_sim::get_more_cta_left() const
 		if( m_total_cta_launched >= m_config.gpu_max_cta_opt )
 			return false;
 	}
-	for(unsigned n=0; n < m_running_kernels.size(); n++ ) {
-		if( m_running_kernels[n] && (!m_running_kernels[n]->no_more_ctas_to_run() || (m_running_kernels[n]->preempted_list.size() != 0)) ) 
+	for(int n=next_running_slot(0); n >= 0; n=next_running_slot(n+1) ) {
+		if( !m_running_kernels[n]->no_more_ctas_to_run() || (m_running_kernels[n]->preempted_list.size() != 0) ) 
 			return true;
 	}
 	return false;
 }
 
+void gpgpu_sim::set_running_slot( unsigned n, kernel_info_t *kernel )
+{
+	if( m_running_slots.test(n) )
+		m_n_running_slots--;
+	m_running_kernels[n] = kernel;
+	m_running_slots.reset(n);
+	m_child_slots.reset(n);
+	if( kernel ) {
+		m_running_slots.set(n);
+		m_n_running_slots++;
+		if( kernel->is_child )
+			m_child_slots.set(n);
+	}
+}
+
+// record a kernel for stat print the first time it is selected for execution
+bool gpgpu_sim::record_executed_kernel( kernel_info_t *kernel )
+{
+	unsigned launch_uid = kernel->get_uid();
+	if( m_executed_kernel_index.find(launch_uid) != m_executed_kernel_index.end() )
+		return false;
+	m_executed_kernel_index[launch_uid] = m_executed_kernel_uids.size();
+	m_executed_kernel_uids.push_back(launch_uid);
+	m_executed_kernel_names.push_back(kernel->name());
+	return true;
+}
+
 /*bool compare_dcc_kd_entry(const dcc_kernel_distributor_t& a, const dcc_kernel_distributor_t& b)
   {
   return a.thread_count > b.thread_count;
   }*/
 
 bool gpgpu_sim::more_device_ctas_to_run(){
-    for(unsigned idx=0; idx < m_running_kernels.size(); idx++ ) {
-	if( m_running_kernels[idx] ){
-	    if ( m_running_kernels[idx]->is_child && !m_running_kernels[idx]->no_more_ctas_to_run() )
-		return true;
-	}
+    for(int idx=m_child_slots.next(0); idx >= 0; idx=m_child_slots.next(idx+1) ) {
+	if ( !m_running_kernels[idx]->no_more_ctas_to_run() )
+	    return true;
     }
     return false;
 }
@@ -709,31 +787,30 @@ kernel_info_t *gpgpu_sim::select_kernel(unsigned cluster_id, unsigned core_id){
 	    if(g_simultaneous_multikernel_within_SM){
 		bool cluster_issuable = m_cluster[cluster_id]->core_can_issue_1block(core_id, m_running_kernels[m_last_issued_kernel]);
 		if(cluster_issuable){
-		    unsigned launch_uid = m_running_kernels[m_last_issued_kernel]->get_uid(); 
-		    if(std::find(m_executed_kernel_uids.begin(), m_executed_kernel_uids.end(), launch_uid) == m_executed_kernel_uids.end()) {
+		    if(record_executed_kernel(m_running_kernels[m_last_issued_kernel])) 
 			m_running_kernels[m_last_issued_kernel]->start_cycle = gpu_sim_cycle + gpu_tot_sim_cycle;
-			m_executed_kernel_uids.push_back(launch_uid); 
-			m_executed_kernel_names.push_back(m_running_kernels[m_last_issued_kernel]->name()); 
-		    }
 		    return m_running_kernels[m_last_issued_kernel];
 		}
 	    } else {
-		unsigned launch_uid = m_running_kernels[m_last_issued_kernel]->get_uid(); 
-		if(std::find(m_executed_kernel_uids.begin(), m_executed_kernel_uids.end(), launch_uid) == m_executed_kernel_uids.end()) {
+		if(record_executed_kernel(m_running_kernels[m_last_issued_kernel])) 
 		    m_running_kernels[m_last_issued_kernel]->start_cycle = gpu_sim_cycle + gpu_tot_sim_cycle;
-		    m_executed_kernel_uids.push_back(launch_uid); 
-		    m_executed_kernel_names.push_back(m_running_kernels[m_last_issued_kernel]->name()); 
-		}
 		return m_running_kernels[m_last_issued_kernel];
 	    }
 	}
 
     }
 
-    /* last issued kernel cannot issue, try another one */
-    for(unsigned n=0; n < m_running_kernels.size(); n++ ) {
-	unsigned idx = (n+m_last_issued_kernel+1)%m_config.max_concurrent_kernel;
-	if( m_running_kernels[idx] && !m_running_kernels[idx]->no_more_ctas_to_run() && (m_running_kernels[idx]->preempted_list.size() == 0) ){
+    /* last issued kernel cannot issue, try another one, round robin over the occupied slots */
+    unsigned start = (m_last_issued_kernel+1)%m_config.max_concurrent_kernel;
+    int idx = next_running_slot(start);
+    if( idx < 0 ) 
+	idx = next_running_slot(0);
+    for(unsigned n=0; idx >= 0 && n < m_n_running_slots; n++ ) {
+	if( n ) {
+	    int next_idx = next_running_slot(idx+1);
+	    idx = next_idx >= 0 ? next_idx : next_running_slot(0);
+	}
+	if( !m_running_kernels[idx]->no_more_ctas_to_run() && (m_running_kernels[idx]->preempted_list.size() == 0) ){
 	    if( m_running_kernels[idx]->next_dispatchable_cycle < gpu_sim_cycle+gpu_tot_sim_cycle /*&& ( total_num_offchip_metadata == 0 || m_running_kernels[idx]->is_child )*/ ) { //add checking if the kernel is dispatchable
 		bool cluster_issuable = m_cluster[cluster_id]->core_can_issue_1block(core_id, m_running_kernels[idx]);
 		if(cluster_issuable){
@@ -745,12 +822,7 @@ kernel_info_t *gpgpu_sim::select_kernel(unsigned cluster_id, unsigned core_id){
 			m_running_kernels[idx]->start_cycle = gpu_sim_cycle + gpu_tot_sim_cycle;
 		    }
 		    // record this kernel for stat print if it is the first time this kernel is selected for execution  
-		    unsigned launch_uid = m_running_kernels[idx]->get_uid(); 
-		    //			assert(std::find(m_executed_kernel_uids.begin(), m_executed_kernel_uids.end(), launch_uid) == m_executed_kernel_uids.end());
-		    if(std::find(m_executed_kernel_uids.begin(), m_executed_kernel_uids.end(), launch_uid) == m_executed_kernel_uids.end()) {
-			m_executed_kernel_uids.push_back(launch_uid); 
-			m_executed_kernel_names.push_back(m_running_kernels[idx]->name()); 
-		    }
+		    record_executed_kernel(m_running_kernels[idx]);
 
 		    return m_running_kernels[idx];
 		}
@@ -818,22 +890,7 @@ void gpgpu_sim::set_kernel_done( kernel_info_t *kernel )
 	//fflush(stdout);
 	unsigned uid = kernel->get_uid();
 	if(g_dyn_child_thread_consolidation){
-		//    	bool child_kernel = false;
-		extern std::list<dcc_kernel_distributor_t> g_cuda_dcc_kernel_distributor;
-		if ( !g_cuda_dcc_kernel_distributor.empty() ){
-			std::list<dcc_kernel_distributor_t>::iterator it;
-			unsigned int i;
-			for( it = g_cuda_dcc_kernel_distributor.begin(), i = 0; it != g_cuda_dcc_kernel_distributor.end(); it++, i++ ){
-				if(it->kernel_grid == kernel){
-					fprintf(stdout, "DCC: retires child kernel %d at entry %u\n", uid, i);
-					//		    child_kernel = true;
-					it = g_cuda_dcc_kernel_distributor.erase(it);
-					fprintf(stdout, "DCC: kernel distributor now has %u entries\n", g_cuda_dcc_kernel_distributor.size());
-					fflush(stdout);
-					break;
-				}
-			}
-		}
+		dcc_kernel_distributor_retire(kernel);
 		//	if( child_kernel == false )
 		//	    m_finished_kernel.push_back(uid);
 	}/* else {*/
@@ -850,7 +907,7 @@ void gpgpu_sim::set_kernel_done( kernel_info_t *kernel )
 			    //launch_one_device_kernel(true, kernel, NULL);
 			}
 			fflush(stdout);
-			*k = NULL;
+			set_running_slot(k - m_running_kernels.begin(), NULL);
 			break;
 		}
 	}
@@ -898,6 +955,17 @@ void set_ptx_warp_size(const struct core_config * warp_size);
 		}
 	}
 
+	if (m_config.checkpoint_at_cycle || m_config.restore_checkpoint[0])
+		m_checkpoint = new sim_checkpoint(this, m_config.checkpoint_at_cycle, m_config.checkpoint_file, m_config.restore_checkpoint);
+
+	m_sampler = NULL;
+	if (m_config.sampling_period)
+		m_sampler = new sim_sampler(this, m_config.sampling_period, m_config.sampling_detailed, m_config.sampling_warm_l2);
+
+	m_memoizer = NULL;
+	if (m_config.gpgpu_memoize_kernels && !m_sampler)
+		m_memoizer = new kernel_memoizer(this);
+
 	icnt_wrapper_init();
 	icnt_create(m_shader_config->n_simt_clusters,m_memory_config->m_n_mem_sub_partition);
 
@@ -905,6 +973,9 @@ void set_ptx_warp_size(const struct core_config * warp_size);
 	fprintf(stdout, "GPGPU-Sim uArch: performance model initialization complete.\n");
 
 	m_running_kernels.resize( config.max_concurrent_kernel, NULL );
+	m_running_slots.resize( config.max_concurrent_kernel );
+	m_child_slots.resize( config.max_concurrent_kernel );
+	m_n_running_slots = 0;
 	m_last_issued_kernel = 0;
 	m_last_cluster_issue = 0;
 	*average_pipeline_duty_cycle=0;
@@ -1066,6 +1137,66 @@ void gpgpu_sim::update_stats() {
         m_total_cta_launched = 0;
 }
 
+void gpgpu_sim::save_state( FILE *fp ) const
+{
+	extern unsigned long long last_GPU_expected_launch_time;
+	extern unsigned long long kernel_consolidation_engine_busy_until;
+	extern unsigned long long global_next_dispatchable_cycle;
+	unsigned long long state[8] = {
+		gpu_tot_sim_cycle + gpu_sim_cycle,
+		gpu_tot_sim_insn + gpu_sim_insn,
+		gpu_tot_issued_cta + m_total_cta_launched,
+		m_dev_malloc,
+		m_child_param_malloc,
+		last_GPU_expected_launch_time,
+		kernel_consolidation_engine_busy_until,
+		global_next_dispatchable_cycle
+	};
+	fwrite(state, sizeof(state), 1, fp);
+	m_global_mem->save(fp);
+	for (unsigned i=0;i<m_memory_config->m_n_mem_sub_partition;i++) 
+		m_memory_sub_partition[i]->save_state(fp);
+}
+
+bool gpgpu_sim::load_state( FILE *fp )
+{
+	extern unsigned long long last_GPU_expected_launch_time;
+	extern unsigned long long kernel_consolidation_engine_busy_until;
+	extern unsigned long long global_next_dispatchable_cycle;
+	unsigned long long state[8];
+	if (fread(state, sizeof(state), 1, fp) != 1)
+		return false;
+	// the cycles of the current (idle) period are added on top by update_stats()
+	gpu_tot_sim_cycle = state[0] - gpu_sim_cycle;
+	gpu_tot_sim_insn = state[1] - gpu_sim_insn;
+	gpu_tot_issued_cta = state[2] - m_total_cta_launched;
+	m_dev_malloc = state[3];
+	m_child_param_malloc = state[4];
+	last_GPU_expected_launch_time = state[5];
+	kernel_consolidation_engine_busy_until = state[6];
+	global_next_dispatchable_cycle = state[7];
+	if (!m_global_mem->load(fp))
+		return false;
+	for (unsigned i=0;i<m_memory_config->m_n_mem_sub_partition;i++) 
+		if (!m_memory_sub_partition[i]->load_state(fp))
+			return false;
+	return true;
+}
+
+void gpgpu_sim::add_replayed_kernel( unsigned long long cycles, unsigned long long insn, unsigned long long ctas )
+{
+	gpu_tot_sim_cycle += cycles;
+	gpu_tot_sim_insn += insn;
+	gpu_tot_issued_cta += ctas;
+}
+
+void gpgpu_sim::warm_L2( new_addr_type addr )
+{
+	addrdec_t raw_addr;
+	m_memory_config->m_address_mapping.addrdec_tlx(addr,&raw_addr);
+	m_memory_sub_partition[raw_addr.sub_partition]->warm_L2(addr, gpu_sim_cycle+gpu_tot_sim_cycle);
+}
+
 void gpgpu_sim::print_stats()
 {
 	FILE *statfout = fopen("gpgpusim_stat.txt", "a"); 
@@ -1193,6 +1324,7 @@ void gpgpu_sim::set_cache_config(std::string kernel_name)
 
 void gpgpu_sim::change_cache_config(FuncCache cache_config)
 {
+	unsigned old_shmem_size = m_shader_config->gpgpu_shmem_size;
 	if(cache_config != m_shader_config->m_L1D_config.get_cache_status()){
 		printf("FLUSH L1 Cache at configuration change between kernels\n");
 		for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) {
@@ -1231,6 +1363,8 @@ void gpgpu_sim::change_cache_config(FuncCache cache_config)
 		default:
 			break;
 	}
+	if(m_shader_config->gpgpu_shmem_size != old_shmem_size)
+		m_shader_config->gpgpu_occupancy_epoch++; //cached kernel occupancy is stale
 }
 
 
@@ -1238,6 +1372,7 @@ void gpgpu_sim::clear_executed_kernel_info()
 {
 	m_executed_kernel_names.clear();
 	m_executed_kernel_uids.clear();
+	m_executed_kernel_index.clear();
 }
 
 void gpgpu_sim::gpu_print_stat_dkc(FILE * statfout)
@@ -1328,6 +1463,10 @@ void gpgpu_sim::gpu_print_stat(FILE * statfout)
 	fprintf(statfout, "gpu_tot_sim_insn = %lld\n", gpu_tot_sim_insn+gpu_sim_insn);
 	fprintf(statfout, "gpu_tot_ipc = %12.4f\n", (float)(gpu_tot_sim_insn+gpu_sim_insn) / (gpu_tot_sim_cycle+gpu_sim_cycle));
 	fprintf(statfout, "gpu_tot_issued_cta = %lld\n", gpu_tot_issued_cta);
+	if (m_sampler)
+		m_sampler->print(statfout);
+	if (m_memoizer)
+		m_memoizer->print(statfout);
 
 	extern unsigned long long g_max_total_param_size;
 	fprintf(statfout, "max_total_param_size = %llu\n", g_max_total_param_size);
@@ -1349,6 +1488,9 @@ void gpgpu_sim::gpu_print_stat(FILE * statfout)
 	fprintf(statfout, "gpu_stall_dramfull = %d\n", gpu_stall_dramfull);
 	fprintf(statfout, "gpu_stall_icnt2sh    = %d\n", gpu_stall_icnt2sh );
 
+	// memory requests in flight
+	mem_fetch::print_pool_stats(statfout);
+
 	time_t curr_time;
 	time(&curr_time);
 	unsigned long long elapsed_time = MAX( curr_time - g_simulation_starttime, 1 );
@@ -1460,6 +1602,14 @@ unsigned gpgpu_sim::max_cta_per_core() const
 	return m_shader_config->max_cta_per_core;
 }
 
+unsigned gpgpu_sim::free_thread_slots() const
+{
+	unsigned not_completed = 0;
+	for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) 
+		not_completed += m_cluster[i]->get_not_completed();
+	return m_shader_config->num_shader() * m_shader_config->n_thread_per_shader - not_completed;
+}
+
 void shader_core_ctx::mem_instruction_stats(const warp_inst_t &inst)
 {
 	unsigned active_count = inst.active_count(); 
@@ -1512,21 +1662,18 @@ bool shader_core_ctx::can_issue_1block(kernel_info_t & kernel) {
 
 int shader_core_ctx::find_available_hwtid(unsigned int cta_size, bool occupy) {
 
-	unsigned int step;
-	for(step = 0; step < m_config->n_thread_per_shader; 
-			step += cta_size) {
-
-		unsigned int hw_tid;
-		for(hw_tid = step; hw_tid < step + cta_size;
-				hw_tid++) {
-		    if(hw_tid == m_config->n_thread_per_shader) break;
-			if(m_occupied_hwtid.test(hw_tid))
-				break;
-		}
-		if(hw_tid == step + cta_size) //consecutive non-active
+	// first cta_size aligned run of cta_size free slots: jump from each
+	// occupied slot (find-first-set over the bitset words) to the next
+	// aligned candidate instead of testing every slot
+	unsigned int step = 0;
+	while(step + cta_size <= m_config->n_thread_per_shader) {
+		unsigned int busy = step ? m_occupied_hwtid._Find_next(step - 1)
+					 : m_occupied_hwtid._Find_first();
+		if(busy >= step + cta_size) //consecutive non-active
 			break;
+		step = (busy / cta_size + 1) * cta_size;
 	}
-	if(step >= m_config->n_thread_per_shader) //didn't find
+	if(step + cta_size > m_config->n_thread_per_shader) //didn't find
 		return -1;
 	else {
 		if(occupy) {
@@ -1539,12 +1686,8 @@ int shader_core_ctx::find_available_hwtid(unsigned int cta_size, bool occupy) {
 }
 
 bool shader_core_ctx::occupy_shader_resource_1block(kernel_info_t & k, bool occupy) {
-	unsigned threads_per_cta  = k.threads_per_cta();
-	const class function_info *kernel = k.entry();
-	unsigned int padded_cta_size = threads_per_cta;
-	unsigned int warp_size = m_config->warp_size; 
-	if (padded_cta_size%warp_size) 
-		padded_cta_size = ((padded_cta_size/warp_size)+1)*(warp_size);
+	const kernel_occupancy_t &occ = m_config->occupancy(k);
+	unsigned int padded_cta_size = occ.padded_cta_size;
 
         float occupied_thread_percentage, occupied_shmem_percentage, occupied_reg_percentage;
         float newblock_thread_percentage, newblock_shmem_percentage, newblock_reg_percentage;
@@ -1553,20 +1696,19 @@ bool shader_core_ctx::occupy_shader_resource_1block(kernel_info_t & k, bool occu
 	if(m_occupied_n_threads + padded_cta_size > m_config->n_thread_per_shader)
 		return false;
 
-	if(find_available_hwtid(padded_cta_size, false) == -1)
+	if(m_occupied_shmem + occ.smem_per_cta > m_config->gpgpu_shmem_size)
 		return false;
 
-	const struct gpgpu_ptx_sim_kernel_info *kernel_info = ptx_sim_kernel_info(kernel);
-
-	if(m_occupied_shmem + kernel_info->smem > m_config->gpgpu_shmem_size)
-		return false;
-
-	unsigned int used_regs = padded_cta_size * ((kernel_info->regs+3)&~3);
+	unsigned int used_regs = occ.regs_per_cta;
 	if(m_occupied_regs + used_regs > m_config->gpgpu_shader_registers)
 		return false;
 
 	if(m_occupied_ctas +1 > m_config->max_cta_per_core)
 		return false;
+
+	// slot search last, after the O(1) counter checks
+	if(find_available_hwtid(padded_cta_size, false) == -1)
+		return false;
 	
 	/* Po-Han DCC: restrict number of parent blocks issued to a SM to reserve resources for child kernels. */
 	extern application_id g_app_name;	
@@ -1603,7 +1745,7 @@ bool shader_core_ctx::occupy_shader_resource_1block(kernel_info_t & k, bool occu
 		occupied_shmem_percentage = (float)m_occupied_shmem / m_config->gpgpu_shmem_size;
 		occupied_reg_percentage = (float)m_occupied_regs / m_config->gpgpu_shader_registers;
 		newblock_thread_percentage = (float)padded_cta_size / m_config->n_thread_per_shader;
-		newblock_shmem_percentage = (float)kernel_info->smem / m_config->gpgpu_shmem_size;
+		newblock_shmem_percentage = (float)occ.smem_per_cta / m_config->gpgpu_shmem_size;
 		newblock_reg_percentage = (float)used_regs / m_config->gpgpu_shader_registers;
 		if (/*occupied_thread_percentage > 0.6 || 
 		      occupied_shmem_percentage > 0.6 || 
@@ -1649,8 +1791,8 @@ bool shader_core_ctx::occupy_shader_resource_1block(kernel_info_t & k, bool occu
 
 	if(occupy) {
 		m_occupied_n_threads += padded_cta_size;
-		m_occupied_shmem += kernel_info->smem;
-		m_occupied_regs += (padded_cta_size * ((kernel_info->regs+3)&~3));
+		m_occupied_shmem += occ.smem_per_cta;
+		m_occupied_regs += occ.regs_per_cta;
 		m_occupied_ctas++;
 
 		printf("GPGPU-Sim uArch: Shader %d occupied %d threads, %d shared mem, %d registers, %d ctas\n",
@@ -1661,12 +1803,8 @@ bool shader_core_ctx::occupy_shader_resource_1block(kernel_info_t & k, bool occu
 }
 
 void shader_core_ctx::release_shader_resource_1block(unsigned hw_ctaid, kernel_info_t & k) {
-	unsigned threads_per_cta  = k.threads_per_cta();
-	const class function_info *kernel = k.entry();
-	unsigned int padded_cta_size = threads_per_cta;
-	unsigned int warp_size = m_config->warp_size; 
-	if (padded_cta_size%warp_size) 
-		padded_cta_size = ((padded_cta_size/warp_size)+1)*(warp_size);
+	const kernel_occupancy_t &occ = m_config->occupancy(k);
+	unsigned int padded_cta_size = occ.padded_cta_size;
 
 	assert(m_occupied_n_threads >= padded_cta_size);
 	m_occupied_n_threads -= padded_cta_size;
@@ -1678,12 +1816,11 @@ void shader_core_ctx::release_shader_resource_1block(unsigned hw_ctaid, kernel_i
 		m_occupied_hwtid.reset(hwtid);
 	m_occupied_cta_to_hwtid.erase(hw_ctaid);
 
-	const struct gpgpu_ptx_sim_kernel_info *kernel_info = ptx_sim_kernel_info(kernel);
 
-	assert(m_occupied_shmem >= (unsigned int)kernel_info->smem);
-	m_occupied_shmem -= kernel_info->smem;
+	assert(m_occupied_shmem >= occ.smem_per_cta);
+	m_occupied_shmem -= occ.smem_per_cta;
 
-	unsigned int used_regs = padded_cta_size * ((kernel_info->regs+3)&~3);
+	unsigned int used_regs = occ.regs_per_cta;
 	assert(m_occupied_regs >= used_regs);
 	m_occupied_regs -= used_regs;
 
@@ -1707,6 +1844,7 @@ extern std::map<unsigned,std::map<unsigned,memory_space*> > local_memory_lookup;
 
 void shader_core_ctx::switching_issue( kernel_info_t &kernel, unsigned global_cta_id ) 
 {
+	wake();
 	kernel.block_state[global_cta_id].time_stamp_switching_issue = gpu_sim_cycle + switching_latency( kernel );
 
 	kernel.inc_running();
@@ -1839,8 +1977,7 @@ void shader_core_ctx::switching_issue( kernel_info_t &kernel, unsigned global_ct
 		m_simt_stack[j] = m_switched_out_cta.m_simt_stack[j - start_thread / m_config->warp_size];
 		m_simt_stack[j]->m_warp_id = j;
 		m_simt_stack[j]->m_cta_id = free_cta_hw_id;
-		m_scoreboard->getRegTable()[j] = m_switched_out_cta.m_regs[j - start_thread/ m_config->warp_size];
-		m_scoreboard->getLongOpRegs()[j] = m_switched_out_cta.m_longopregs[j - start_thread/ m_config->warp_size];
+		m_scoreboard->restoreRegisters(j, m_switched_out_cta.m_regs[j - start_thread/ m_config->warp_size], m_switched_out_cta.m_longopregs[j - start_thread/ m_config->warp_size]);
 
 		/* rebuild barrier status */
 		for(unsigned bar_id = 0; bar_id < m_barriers.m_max_barriers_per_cta; bar_id++)
@@ -1903,6 +2040,7 @@ void shader_core_ctx::context_switch_1_block()
 void shader_core_ctx::issue_block2core( kernel_info_t &kernel ) 
 {
 	//    set_max_cta(kernel);
+	wake();
 	kernel.inc_running();
 	assert(occupy_shader_resource_1block(kernel, true));
 
@@ -2030,7 +2168,7 @@ void gpgpu_sim::issue_block2core()
    // this function should be envoke mutiple times until this cta is "preempted" (we probably cannot switch this cta right now)
    std::list<unsigned int>::iterator it;
    unsigned b_idx;
-   for(unsigned n=0; n < m_running_kernels.size(); n++ ) {
+   for(int n=next_running_slot(0); n >= 0; n=next_running_slot(n+1) ) {
       kernel_info_t *kernel = m_running_kernels[n];
       if(kernel && !g_simultaneous_multikernel_within_SM){
       //if(kernel && !g_dyn_child_thread_consolidation){
@@ -2371,6 +2509,194 @@ void gpgpu_sim::cycle()
 	}
 }
 
+// Number of core cycles, starting with the next one, that cycle() would spend
+// only on idle statistics: all threads have completed (and sleep if their
+// cores are cycled), the memory system and interconnect are empty, and CTA
+// issue, device kernel launch and the periodic reports have nothing to do.
+unsigned long long gpgpu_sim::idle_core_cycles()
+{
+	if( g_single_step || g_interactive_debugger_enabled || m_config.gpgpu_flush_l1_cache || m_config.gpgpu_flush_l2_cache )
+		return 0;
+#ifdef GPGPUSIM_POWER_MODEL
+	if( m_config.g_power_simulation_enabled )
+		return 0;
+#endif
+	bool core_cycled = get_more_cta_left();
+	for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) 
+		if( !m_cluster[i]->idle(core_cycled) ) 
+			return 0;
+	for (unsigned i=0;i<m_memory_config->m_n_mem;i++) 
+		if( !m_memory_partition_unit[i]->quiescent() ) 
+			return 0;
+	if( icnt_busy() )
+		return 0;
+
+	extern bool g_estimate_offchip_metadata_load_latency, g_child_aware_smk_scheduling;
+	extern bool last_undispatched_device_TBs;
+	extern unsigned long long last_period;
+	extern unsigned int DPS_period;
+	unsigned long long now = gpu_sim_cycle + gpu_tot_sim_cycle;
+	if( g_child_aware_smk_scheduling && more_device_ctas_to_run() != last_undispatched_device_TBs )
+		return 0;
+
+	unsigned long long idle = device_launch_idle_cycles(now);
+	unsigned long long issue_idle = block_issue_idle_cycles(now);
+	idle = gs_min2(idle, issue_idle);
+	if( g_estimate_offchip_metadata_load_latency && g_child_aware_smk_scheduling ) {
+		// the DPS report is due once DPS_period cycles have passed
+		if( now - last_period >= DPS_period ) 
+			return 0;
+		idle = gs_min2(idle, DPS_period - (now - last_period));
+	}
+	// runtime statistics, deadlock detection, snap shots and spills
+	unsigned long long sample_freq = m_config.gpu_stat_sample_freq;
+	idle = gs_min2(idle, sample_freq - gpu_sim_cycle % sample_freq - 1);
+	idle = gs_min2(idle, 100000 - gpu_sim_cycle % 100000 - 1);
+	unsigned long long log_idle = stat_log_idle_cycles(gpu_sim_cycle);
+	idle = gs_min2(idle, log_idle);
+	if( m_config.gpu_max_cycle_opt ) 
+		idle = (m_config.gpu_max_cycle_opt > now + 1) ? gs_min2(idle, m_config.gpu_max_cycle_opt - now - 1) : 0;
+	return idle;
+}
+
+// Number of core cycles, starting with the next one, in which the
+// block_scheduling_delay countdown and issue_block2core() issue, switch or
+// reissue no CTA.
+unsigned long long gpgpu_sim::block_issue_idle_cycles( unsigned long long now ) const
+{
+	extern unsigned int block_scheduling_delay;
+	bool no_ctas = true;
+	bool no_switches = true;
+	for(int n=next_running_slot(0); n >= 0; n=next_running_slot(n+1) ) {
+		kernel_info_t *kernel = m_running_kernels[n];
+		if( !kernel->no_more_ctas_to_run() ) 
+			no_ctas = false;
+		if( !g_simultaneous_multikernel_within_SM && (kernel->preswitch_list.size() || kernel->switching_list.size()) )
+			no_switches = false;
+		for( std::list<unsigned int>::const_iterator it = kernel->preempted_list.begin(); it != kernel->preempted_list.end(); it++ )
+			if( kernel->block_state[*it].reissue ) 
+				no_ctas = false;
+	}
+	if( no_ctas && no_switches ) 
+		return (unsigned long long)-1;
+
+	unsigned long long idle = block_scheduling_delay ? block_scheduling_delay - 1 : 0;
+	if( no_switches ) {
+		// each cluster skips its cores until their next_dispatchable_cycle
+		unsigned long long dispatchable = (unsigned long long)-1;
+		for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) 
+			for (unsigned c=0;c<m_shader_config->n_simt_cores_per_cluster;c++) 
+				dispatchable = gs_min2(dispatchable, m_cluster[i]->m_core[c]->next_dispatchable_cycle);
+		if( dispatchable > now && dispatchable - now > idle ) 
+			idle = dispatchable - now;
+	}
+	return idle;
+}
+
+// Runs up to max_cycles calls of cycle() in one step when idle_core_cycles()
+// shows that they would only update idle statistics.  The clock domains are
+// still stepped one edge at a time so that their times add up exactly as in
+// cycle(), and the (empty) interconnect is still advanced on its edges; the
+// statistics of the cores, caches and DRAM are updated in bulk.  Returns the
+// number of cycle() calls covered.
+unsigned long long gpgpu_sim::fast_forward_idle( unsigned long long max_cycles )
+{
+	unsigned long long horizon = idle_core_cycles();
+	if( horizon == 0 ) 
+		return 0;
+
+	unsigned long long n = 0;
+	unsigned core_cycles = 0, dram_cycles = 0, l2_cycles = 0;
+	while( n < max_cycles ) {
+		double last_core_time = core_time, last_icnt_time = icnt_time, last_dram_time = dram_time, last_l2_time = l2_time;
+		int clock_mask = next_clock_domain();
+		if( (clock_mask & CORE) && core_cycles == horizon ) {
+			core_time = last_core_time;
+			icnt_time = last_icnt_time;
+			dram_time = last_dram_time;
+			l2_time = last_l2_time;
+			break;
+		}
+		n++;
+		if (clock_mask & CORE) core_cycles++;
+		if (clock_mask & DRAM) dram_cycles++;
+		if (clock_mask & L2) l2_cycles++;
+		if (clock_mask & ICNT) icnt_transfer();
+	}
+
+	if (dram_cycles) {
+		for (unsigned i=0;i<m_memory_config->m_n_mem;i++){
+			m_memory_partition_unit[i]->idle_dram_cycle(dram_cycles);
+			m_memory_partition_unit[i]->set_dram_power_stats(m_power_stats->pwr_mem_stat->n_cmd[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_activity[CURRENT_STAT_IDX][i],
+				m_power_stats->pwr_mem_stat->n_nop[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_act[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_pre[CURRENT_STAT_IDX][i],
+				m_power_stats->pwr_mem_stat->n_rd[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_wr[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_req[CURRENT_STAT_IDX][i]);
+		}
+	}
+	if (l2_cycles) {
+		m_power_stats->pwr_mem_stat->l2_cache_stats[CURRENT_STAT_IDX].clear();
+		for (unsigned i=0;i<m_memory_config->m_n_mem_sub_partition;i++) {
+			m_memory_sub_partition[i]->idle_cache_cycle(l2_cycles);
+			m_memory_sub_partition[i]->accumulate_L2cache_stats(m_power_stats->pwr_mem_stat->l2_cache_stats[CURRENT_STAT_IDX]);
+		}
+	}
+
+	if (core_cycles) {
+		extern bool child_running;
+		extern unsigned long long child_running_cycles;
+		if(child_running) child_running_cycles += core_cycles;
+
+		extern bool tdq_full, child_consuming_rate_higher;
+		extern bool g_estimate_offchip_metadata_load_latency, g_child_aware_smk_scheduling;
+		extern unsigned int g_kernel_queue_entry_cnt, g_kernel_queue_entry_used;
+		extern unsigned long long potential_child_kernels;
+		if (!g_estimate_offchip_metadata_load_latency || !g_child_aware_smk_scheduling) {
+			tdq_full = false;
+			child_consuming_rate_higher = false;
+		} else {
+			tdq_full = (g_kernel_queue_entry_used + potential_child_kernels + 32 < g_kernel_queue_entry_cnt + 10) ? false : true;
+		}
+
+		// the duty cycle of a sleeping core drops to zero after its first cycle;
+		// no core is active, so active_sms does not change
+		bool core_cycled = get_more_cta_left();
+		float temp = 0;
+		for (unsigned k=0;k<core_cycles;k++) {
+			if (k < 2) {
+				if (core_cycled) {
+					for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) 
+						m_cluster[i]->idle_core_cycle(k == 0 ? 1 : core_cycles - 1);
+				}
+				temp=0;
+				for (unsigned i=0;i<m_shader_config->num_shader();i++){
+					temp+=m_shader_stats->m_pipeline_duty_cycle[i];
+				}
+				temp=temp/m_shader_config->num_shader();
+			}
+			*average_pipeline_duty_cycle=((*average_pipeline_duty_cycle)+temp);
+		}
+		m_power_stats->pwr_mem_stat->core_cache_stats[CURRENT_STAT_IDX].clear();
+		for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) {
+			m_cluster[i]->get_icnt_stats(m_power_stats->pwr_mem_stat->n_simt_to_mem[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_mem_to_simt[CURRENT_STAT_IDX][i]);
+			m_cluster[i]->get_cache_stats(m_power_stats->pwr_mem_stat->core_cache_stats[CURRENT_STAT_IDX]);
+		}
+
+		gpu_sim_cycle += core_cycles;
+
+		extern unsigned int block_scheduling_delay;
+		block_scheduling_delay = (block_scheduling_delay > core_cycles) ? block_scheduling_delay - core_cycles : 0;
+		device_launch_skip_idle();
+
+		extern unsigned long long total_num_offchip_metadata;
+		if( total_num_offchip_metadata > 0 ){
+		    extern unsigned long long num_cycles_exist_offchip_metadata;
+		    extern unsigned long long accumulate_num_offchip_metadata;
+		    num_cycles_exist_offchip_metadata += core_cycles;
+		    accumulate_num_offchip_metadata += core_cycles * total_num_offchip_metadata;
+		}
+	}
+	return n;
+}
+
 
 void shader_core_ctx::dump_warp_state( FILE *fout ) const
 {
@@ -31,6 +31,7 @@
 #include "../option_parser.h"
 #include "../abstract_hardware_model.h"
 #include "../trace.h"
+#include "../tr1_hash_map.h"
 #include "addrdec.h"
 #include "shader.h"
 #include <iostream>
@@ -287,6 +288,11 @@ public:
         gpu_runtime_stat_flag = 0;
         sscanf(gpgpu_runtime_stat, "%d:%x", &gpu_stat_sample_freq, &gpu_runtime_stat_flag);
         m_shader_config.init();
+        if (gpgpu_idle_fast_forward && !m_shader_config.gpgpu_core_sleep) {
+            // the skipped cycles are only known to be idle for cores that sleep
+            printf("GPGPU-Sim uArch: ERROR ** -gpgpu_idle_fast_forward requires -gpgpu_core_sleep 1\n");
+            abort();
+        }
         ptx_set_tex_cache_linesize(m_shader_config.m_L1T_config.get_line_sz());
         m_memory_config.init();
         init_clock_domains(); 
@@ -314,6 +320,7 @@ public:
     unsigned num_shader() const { return m_shader_config.num_shader(); }
     unsigned num_cluster() const { return m_shader_config.n_simt_clusters; }
     unsigned get_max_concurrent_kernel() const { return max_concurrent_kernel; }
+    bool idle_fast_forward() const { return gpgpu_idle_fast_forward; }
     double core_freq;
     double dram_freq;
     memory_config m_memory_config;
@@ -347,6 +354,14 @@ private:
     int   gpgpu_cflog_interval;
     char * gpgpu_clock_domains;
     unsigned max_concurrent_kernel;
+    bool  gpgpu_idle_fast_forward;
+    unsigned long long checkpoint_at_cycle;
+    char *checkpoint_file;
+    char *restore_checkpoint;
+    unsigned sampling_period;
+    unsigned sampling_detailed;
+    bool  sampling_warm_l2;
+    bool  gpgpu_memoize_kernels;
 
     // visualizer
     bool  g_visualizer_enabled;
@@ -370,6 +385,44 @@ private:
 typedef std::bitset<WARP_PER_CTA_MAX> w_set_t;
 typedef std::bitset<32> t_set_t;
 
+// bitmap over the kernel table slots; lets the per-cycle kernel scans visit
+// only the occupied slots instead of all max_concurrent_kernel entries
+class kernel_slot_mask {
+public:
+   void resize( unsigned n ) { m_n = n; m_words.assign((n+63)/64, 0); }
+   void set( unsigned i ) { m_words[i>>6] |= 1ULL << (i&63); }
+   void reset( unsigned i ) { m_words[i>>6] &= ~(1ULL << (i&63)); }
+   bool test( unsigned i ) const { return (m_words[i>>6] >> (i&63)) & 1; }
+
+   // first set slot at or after i, -1 if there is none
+   int next( unsigned i ) const
+   {
+      for( unsigned w = i>>6; i < m_n; w++, i = w<<6 ) {
+         unsigned long long bits = m_words[w] & (~0ULL << (i&63));
+         if( bits ) {
+            unsigned idx = (w<<6) + __builtin_ctzll(bits);
+            return idx < m_n ? (int)idx : -1;
+         }
+      }
+      return -1;
+   }
+   // first clear slot at or after 0, m_n if every slot is set
+   unsigned first_clear() const
+   {
+      for( unsigned w = 0; w < m_words.size(); w++ ) {
+         if( ~m_words[w] ) {
+            unsigned idx = (w<<6) + __builtin_ctzll(~m_words[w]);
+            return idx < m_n ? idx : m_n;
+         }
+      }
+      return m_n;
+   }
+
+private:
+   unsigned m_n;
+   std::vector<unsigned long long> m_words;
+};
+
 class gpgpu_sim : public gpgpu_t {
 public:
    gpgpu_sim( const gpgpu_sim_config &config );
@@ -379,15 +432,28 @@ public:
    void launch( kernel_info_t *kinfo );
    unsigned can_start_kernel();
    unsigned finished_kernel();
+   bool has_finished_kernel() const { return !m_finished_kernel.empty(); }
    void set_kernel_done( kernel_info_t *kernel );
 
    void init();
    void cycle();
+   unsigned long long fast_forward_idle( unsigned long long max_cycles );
    bool active(); 
    void print_stats();
    void update_stats();
    void deadlock_check();
 
+   // state carried across a drained host kernel boundary (see checkpoint.h)
+   void save_state( FILE *fp ) const;
+   bool load_state( FILE *fp );
+
+   class sim_sampler *get_sampler() { return m_sampler; }
+   void warm_L2( new_addr_type addr );
+
+   class kernel_memoizer *get_memoizer() { return m_memoizer; }
+   unsigned long long tot_issued_cta() const { return gpu_tot_issued_cta + m_total_cta_launched; }
+   void add_replayed_kernel( unsigned long long cycles, unsigned long long insn, unsigned long long ctas );
+
    void get_pdom_stack_top_info( unsigned sid, unsigned tid, unsigned *pc, unsigned *rpc );
 
    int shared_mem_size() const;
@@ -399,6 +465,7 @@ public:
 
    unsigned threads_per_core() const;
    unsigned max_cta_per_core() const;
+   unsigned free_thread_slots() const;
    bool get_more_cta_left() const;
    kernel_info_t *select_kernel(unsigned, unsigned);
    bool more_device_ctas_to_run();
@@ -446,11 +513,19 @@ public:
 
 
    std::vector<kernel_info_t*> m_running_kernels;
+   // occupied (non-NULL) slots of m_running_kernels, iterate with
+   // for( int n = next_running_slot(0); n >= 0; n = next_running_slot(n+1) )
+   int next_running_slot( unsigned from ) const { return m_running_slots.next(from); }
 private:
+   void set_running_slot( unsigned n, kernel_info_t *kernel );
+   bool record_executed_kernel( kernel_info_t *kernel );
+
    // clocks
    void reinit_clock_domains(void);
    int  next_clock_domain(void);
    void issue_block2core();
+   unsigned long long idle_core_cycles();
+   unsigned long long block_issue_idle_cycles( unsigned long long now ) const;
    void print_dram_stats(FILE *fout) const;
    void shader_print_runtime_stat( FILE *fout );
    void shader_print_l1_miss_stat( FILE *fout ) const;
@@ -467,8 +542,13 @@ private:
    class simt_core_cluster **m_cluster;
    class memory_partition_unit **m_memory_partition_unit;
    class memory_sub_partition **m_memory_sub_partition;
+   class sim_sampler *m_sampler; // NULL unless -sampling_period is set
+   class kernel_memoizer *m_memoizer; // NULL unless -gpgpu_memoize_kernels is set
 
    unsigned m_last_issued_kernel;
+   kernel_slot_mask m_running_slots; // m_running_kernels[n] != NULL
+   kernel_slot_mask m_child_slots; // ... and holds a device (child) kernel
+   unsigned m_n_running_slots;
 
    std::list<unsigned> m_finished_kernel;
    unsigned m_total_cta_launched;
@@ -505,6 +585,7 @@ private:
 
    std::vector<std::string> m_executed_kernel_names; //< names of kernel for stat printout 
    std::vector<unsigned> m_executed_kernel_uids; //< uids of kernel launches for stat printout
+   tr1_hash_map<unsigned,unsigned> m_executed_kernel_index; //< uid -> position in m_executed_kernel_uids
    std::string executed_kernel_info_string(); //< format the kernel information into a string for stat printout
    void clear_executed_kernel_info(); //< clear the kernel information after stat printout
 
@@ -249,6 +249,24 @@ void memory_partition_unit::dram_cycle()
     }
 }
 
+bool memory_partition_unit::quiescent() const
+{
+    if (!m_dram->quiescent() || !m_dram_latency_queue.empty()) 
+        return false; 
+    for (unsigned p = 0; p < m_config->m_n_sub_partition_per_memory_channel; p++) {
+        if (!m_sub_partition[p]->quiescent()) 
+            return false; 
+    }
+    return true; 
+}
+
+void memory_partition_unit::idle_dram_cycle( unsigned n ) 
+{
+    m_dram->idle_cycle(n); 
+    for (unsigned i = 0; i < n; i++) 
+        m_dram->dram_log(SAMPLELOG); 
+}
+
 void memory_partition_unit::set_done( mem_fetch *mf )
 {
     unsigned global_spid = mf->get_sub_partition_id(); 
@@ -546,6 +564,20 @@ bool memory_sub_partition::busy() const
     return !m_request_tracker.empty();
 }
 
+bool memory_sub_partition::quiescent() const 
+{
+    if (busy() || !m_rop.empty() || !m_icnt_L2_queue->empty() || !m_L2_dram_queue->empty() 
+        || !m_dram_L2_queue->empty() || !m_L2_icnt_queue->empty()) 
+        return false; 
+    return m_config->m_L2_config.disabled() || m_L2cache->quiescent(); 
+}
+
+void memory_sub_partition::idle_cache_cycle( unsigned n ) 
+{
+    if (!m_config->m_L2_config.disabled()) 
+        m_L2cache->idle_cycle(n); 
+}
+
 void memory_sub_partition::push( mem_fetch* req, unsigned long long cycle ) 
 {
     if (req) {
@@ -600,6 +632,25 @@ void memory_sub_partition::accumulate_L2cache_stats(class cache_stats &l2_stats)
     }
 }
 
+void memory_sub_partition::warm_L2( new_addr_type addr, unsigned time )
+{
+    if (!m_config->m_L2_config.disabled())
+        m_L2cache->warm(addr, time);
+}
+
+void memory_sub_partition::save_state( FILE *fp ) const
+{
+    if (!m_config->m_L2_config.disabled())
+        m_L2cache->save_tags(fp);
+}
+
+bool memory_sub_partition::load_state( FILE *fp )
+{
+    if (!m_config->m_L2_config.disabled())
+        return m_L2cache->load_tags(fp);
+    return true;
+}
+
 void memory_sub_partition::get_L2cache_sub_stats(struct cache_sub_stats &css) const{
     if (!m_config->m_L2_config.disabled()) {
         m_L2cache->get_sub_stats(css);
@@ -65,6 +65,10 @@ public:
 
    void cache_cycle( unsigned cycle );
    void dram_cycle();
+   // true if dram_cycle() and the cache_cycle() of every sub partition only
+   // update idle statistics; idle_dram_cycle(n) stands for n dram_cycle()
+   bool quiescent() const;
+   void idle_dram_cycle( unsigned n );
 
    void set_done( mem_fetch *mf );
 
@@ -153,6 +157,8 @@ public:
    bool busy() const;
 
    void cache_cycle( unsigned cycle );
+   bool quiescent() const;
+   void idle_cache_cycle( unsigned n ); // n cache_cycle() while quiescent()
 
    bool full() const;
    void push( class mem_fetch* mf, unsigned long long clock_cycle );
@@ -178,6 +184,12 @@ public:
    void accumulate_L2cache_stats(class cache_stats &l2_stats) const;
    void get_L2cache_sub_stats(struct cache_sub_stats &css) const;
 
+   void warm_L2( new_addr_type addr, unsigned time );
+
+   // L2 tag state for simulation checkpoints
+   void save_state( FILE *fp ) const;
+   bool load_state( FILE *fp );
+
 private:
 // data
    unsigned m_id;  //< the global sub partition ID
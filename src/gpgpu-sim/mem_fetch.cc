@@ -32,6 +32,135 @@
 #include "gpu-sim.h"
 
 unsigned mem_fetch::sm_next_mf_request_uid=1;
+unsigned mem_fetch::sm_n_live[NUM_MEM_ACCESS_TYPE];
+unsigned mem_fetch::sm_max_live[NUM_MEM_ACCESS_TYPE];
+
+// Fixed-size slot allocator behind mem_fetch::operator new/delete.  Slots are
+// carved out of slabs that are never returned to the heap.
+// Build with -DDEBUG_MEM_FETCH_POOL to tag every slot so that double frees
+// and foreign pointers abort, and to report leaked requests at exit.
+#define MF_POOL_SLAB_SLOTS 1024
+#define MF_POOL_ALIGN 16
+
+#ifdef DEBUG_MEM_FETCH_POOL
+#define MF_POOL_HEADER MF_POOL_ALIGN
+#define MF_POOL_LIVE_TAG 0x6d66a11cu
+#define MF_POOL_FREE_TAG 0x6d66f7eeu
+#else
+#define MF_POOL_HEADER 0
+#endif
+
+class mem_fetch_pool {
+public:
+   mem_fetch_pool()
+      : m_free(NULL), m_n_live(0), m_max_live(0), m_n_slabs(0)
+   {
+      m_slot_size = (MF_POOL_HEADER + sizeof(mem_fetch) + MF_POOL_ALIGN - 1) & ~(MF_POOL_ALIGN - 1);
+   }
+#ifdef DEBUG_MEM_FETCH_POOL
+   ~mem_fetch_pool()
+   {
+      if( m_n_live )
+         fprintf(stderr, "GPGPU-Sim: %u mem_fetch objects still allocated at exit\n", m_n_live);
+   }
+#endif
+
+   void *alloc()
+   {
+      if( m_free == NULL )
+         grow();
+      free_slot *s = m_free;
+      m_free = s->next;
+      if( ++m_n_live > m_max_live )
+         m_max_live = m_n_live;
+#ifdef DEBUG_MEM_FETCH_POOL
+      unsigned *tag = (unsigned*)s;
+      assert( *tag == MF_POOL_FREE_TAG );
+      *tag = MF_POOL_LIVE_TAG;
+#endif
+      return (char*)s + MF_POOL_HEADER;
+   }
+
+   void release( void *p )
+   {
+      free_slot *s = (free_slot*)((char*)p - MF_POOL_HEADER);
+#ifdef DEBUG_MEM_FETCH_POOL
+      unsigned *tag = (unsigned*)s;
+      if( *tag != MF_POOL_LIVE_TAG ) {
+         fprintf(stderr, "GPGPU-Sim: %s of mem_fetch %p\n", (*tag == MF_POOL_FREE_TAG)? "double free" : "bad free", p);
+         abort();
+      }
+      *tag = MF_POOL_FREE_TAG;
+      memset(p, 0xdb, sizeof(mem_fetch)); // poison to catch use after free
+#endif
+      s->next = m_free;
+      m_free = s;
+      m_n_live--;
+   }
+
+   unsigned n_live() const { return m_n_live; }
+   unsigned max_live() const { return m_max_live; }
+   unsigned capacity() const { return m_n_slabs * MF_POOL_SLAB_SLOTS; }
+
+private:
+   // a free slot holds the free-list link (after the tag in debug builds)
+   struct free_slot {
+#ifdef DEBUG_MEM_FETCH_POOL
+      unsigned tag[MF_POOL_HEADER / sizeof(unsigned)];
+#endif
+      free_slot *next;
+   };
+
+   void grow()
+   {
+      char *slab = (char*)::operator new( (size_t)m_slot_size * MF_POOL_SLAB_SLOTS );
+      for( int i = MF_POOL_SLAB_SLOTS - 1; i >= 0; i-- ) {
+         free_slot *s = (free_slot*)(slab + (size_t)i * m_slot_size);
+#ifdef DEBUG_MEM_FETCH_POOL
+         s->tag[0] = MF_POOL_FREE_TAG;
+#endif
+         s->next = m_free;
+         m_free = s;
+      }
+      m_n_slabs++;
+   }
+
+   free_slot *m_free;
+   unsigned m_slot_size;
+   unsigned m_n_live;
+   unsigned m_max_live;
+   unsigned m_n_slabs;
+};
+
+static mem_fetch_pool g_mem_fetch_pool;
+
+void *mem_fetch::operator new( size_t size )
+{
+   assert( size == sizeof(mem_fetch) );
+   return g_mem_fetch_pool.alloc();
+}
+
+void mem_fetch::operator delete( void *p )
+{
+   if( p )
+      g_mem_fetch_pool.release(p);
+}
+
+void mem_fetch::update_live( enum mem_access_type type, int delta )
+{
+   sm_n_live[type] += delta;
+   if( sm_n_live[type] > sm_max_live[type] )
+      sm_max_live[type] = sm_n_live[type];
+}
+
+void mem_fetch::print_pool_stats( FILE *fp )
+{
+   fprintf(fp, "mem_fetch_live = %u\n", g_mem_fetch_pool.n_live());
+   fprintf(fp, "mem_fetch_max_live = %u\n", g_mem_fetch_pool.max_live());
+   fprintf(fp, "mem_fetch_pool_capacity = %u\n", g_mem_fetch_pool.capacity());
+   for( unsigned t=0; t < NUM_MEM_ACCESS_TYPE; t++ )
+      fprintf(fp, "mem_fetch_live[%s] = %u (max %u)\n", mem_access_type_str((enum mem_access_type)t), sm_n_live[t], sm_max_live[t]);
+}
 
 mem_fetch::mem_fetch( const mem_access_t &access, 
                       const warp_inst_t *inst,
@@ -61,10 +190,12 @@ mem_fetch::mem_fetch( const mem_access_t &access,
    m_status_change = gpu_sim_cycle + gpu_tot_sim_cycle;
    m_mem_config = config;
    icnt_flit_size = config->icnt_flit_size;
+   update_live(m_access.get_type(), 1);
 }
 
 mem_fetch::~mem_fetch()
 {
+    update_live(m_access.get_type(), -1);
     m_status = MEM_FETCH_DELETED;
 }
 
@@ -58,6 +58,12 @@ public:
                const class memory_config *config );
    ~mem_fetch();
 
+   // mem_fetch objects (with their embedded mem_access_t and warp_inst_t)
+   // are recycled through a free list instead of the general heap
+   static void *operator new( size_t size );
+   static void operator delete( void *p );
+   static void print_pool_stats( FILE *fp );
+
    void set_status( enum mem_fetch_status status, unsigned long long cycle );
    void set_reply() 
    { 
@@ -140,6 +146,11 @@ private:
 
    static unsigned sm_next_mf_request_uid;
 
+   // in-flight requests per access type and their high-water marks
+   static unsigned sm_n_live[NUM_MEM_ACCESS_TYPE];
+   static unsigned sm_max_live[NUM_MEM_ACCESS_TYPE];
+   static void update_live( enum mem_access_type type, int delta );
+
    const class memory_config *m_mem_config;
    unsigned icnt_flit_size;
 };
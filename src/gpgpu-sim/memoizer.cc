@@ -0,0 +1,176 @@
+#include "memoizer.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "gpu-sim.h"
+#include "../abstract_hardware_model.h"
+#include "../cuda-sim/ptx_ir.h"
+
+// FNV-1a
+static unsigned long long hash_bytes( unsigned long long h, const void *data, size_t n )
+{
+   const unsigned char *p = (const unsigned char*)data;
+   for( size_t i=0; i < n; i++ ) {
+      h ^= p[i];
+      h *= 0x100000001b3ULL;
+   }
+   return h;
+}
+#define HASH_INIT 0xcbf29ce484222325ULL
+
+kernel_memoizer::kernel_memoizer( gpgpu_sim *gpu )
+   : m_gpu(gpu), m_last_uid(0), m_recording_uid(0), m_recording_valid(false), m_key(0),
+     m_start_cycle(0), m_start_insn(0), m_start_ctas(0), m_start_child_param(0), m_bsize(0),
+     m_n_memoized(0), m_n_recorded(0), m_memoized_cycles(0)
+{
+}
+
+unsigned long long kernel_memoizer::fingerprint( kernel_info_t *kernel ) const
+{
+   const function_info *entry = kernel->entry();
+   dim3 grid = kernel->get_grid_dim(-1);
+   dim3 cta = kernel->get_cta_dim();
+   unsigned long long h = HASH_INIT;
+   h = hash_bytes(h, &entry, sizeof(entry));
+   h = hash_bytes(h, &grid, sizeof(grid));
+   h = hash_bytes(h, &cta, sizeof(cta));
+
+   unsigned n_param = kernel->entry()->get_args_aligned_size();
+   std::vector<unsigned char> param(n_param);
+   if( n_param )
+      kernel->get_param_memory(-1)->read(0, n_param, &param[0]);
+   h = hash_bytes(h, &n_param, sizeof(n_param));
+   if( n_param )
+      h = hash_bytes(h, &param[0], n_param);
+   return h;
+}
+
+unsigned long long kernel_memoizer::block_hash( mem_addr_t blk_idx ) const
+{
+   std::vector<unsigned char> data(m_bsize);
+   m_gpu->get_global_memory()->read(blk_idx * m_bsize, m_bsize, &data[0]);
+   return hash_bytes(HASH_INIT, &data[0], m_bsize);
+}
+
+bool kernel_memoizer::host_kernel_ready( kernel_info_t *kernel )
+{
+   // a kernel may wait at the front of its stream for many cycles
+   if( kernel->get_uid() == m_last_uid )
+      return false;
+   m_last_uid = kernel->get_uid();
+   if( m_recording_uid || m_gpu->active() )
+      return false;
+
+   unsigned long long key = fingerprint(kernel);
+   tr1_hash_map<unsigned long long, memo_record>::iterator r = m_records.find(key);
+   if( r != m_records.end() ) {
+      const memo_record &rec = r->second;
+      bool match = true;
+      for( unsigned b=0; match && b < rec.in_block.size(); b++ )
+         match = block_hash(rec.in_block[b]) == rec.in_hash[b];
+      if( match ) {
+         memory_space *mem = m_gpu->get_global_memory();
+         for( unsigned b=0; b < rec.out_block.size(); b++ )
+            mem->write(rec.out_block[b] * m_bsize, m_bsize, &rec.out_data[b * m_bsize], NULL, NULL);
+         m_gpu->add_replayed_kernel(rec.cycles, rec.insn, rec.ctas);
+         m_n_memoized++;
+         m_memoized_cycles += rec.cycles;
+         printf("GPGPU-Sim: kernel %d: \'%s\' memoized (%llu cycles, %zu blocks written)\n",
+                kernel->get_uid(), kernel->name().c_str(), rec.cycles, rec.out_block.size());
+         return true;
+      }
+   }
+
+   m_recording_uid = kernel->get_uid();
+   m_recording_valid = true;
+   m_key = key;
+   m_start_cycle = gpu_sim_cycle + gpu_tot_sim_cycle;
+   m_start_insn = m_gpu->gpu_sim_insn + m_gpu->gpu_tot_sim_insn;
+   m_start_ctas = m_gpu->tot_issued_cta();
+   m_start_child_param = m_gpu->child_param_top();
+   m_gpu->get_global_memory()->set_observer(this);
+   m_gpu->get_tex_memory()->set_observer(this);
+   m_gpu->get_surf_memory()->set_observer(this);
+   return false;
+}
+
+void kernel_memoizer::touch( memory_space *mem, mem_addr_t blk_idx, unsigned bsize, bool write )
+{
+   if( mem != m_gpu->get_global_memory() ) {
+      // texture and surface contents are not fingerprinted
+      m_recording_valid = false;
+      return;
+   }
+   m_bsize = bsize;
+   tr1_hash_map<mem_addr_t, touched_block>::iterator t = m_touched.find(blk_idx);
+   if( t == m_touched.end() ) {
+      // insert first: hashing the block reads it again
+      touched_block &blk = m_touched[blk_idx];
+      blk.written = false;
+      blk.hash = block_hash(blk_idx);
+      t = m_touched.find(blk_idx);
+   }
+   if( write )
+      t->second.written = true;
+}
+
+void kernel_memoizer::operation_done( kernel_info_t *kernel )
+{
+   if( !m_recording_uid )
+      return;
+   kernel_info_t *root = kernel;
+   while( root && root->get_parent() )
+      root = root->get_parent();
+   if( root == NULL || root->get_uid() != m_recording_uid )
+      m_recording_valid = false; // memory could change under the recorded kernel
+}
+
+void kernel_memoizer::host_kernel_finished( kernel_info_t *kernel )
+{
+   if( kernel->get_uid() != m_recording_uid )
+      return;
+   // device launches allocate parameter buffers, so the launch would not repeat
+   if( m_gpu->child_param_top() != m_start_child_param )
+      m_recording_valid = false;
+
+   if( m_recording_valid ) {
+      memo_record &rec = m_records[m_key];
+      rec.in_block.clear();
+      rec.in_hash.clear();
+      rec.out_block.clear();
+      rec.out_data.clear();
+      for( tr1_hash_map<mem_addr_t, touched_block>::iterator t=m_touched.begin(); t != m_touched.end(); t++ ) {
+         rec.in_block.push_back(t->first);
+         rec.in_hash.push_back(t->second.hash);
+         if( t->second.written )
+            rec.out_block.push_back(t->first);
+      }
+      stop_recording();
+      rec.out_data.resize(rec.out_block.size() * m_bsize);
+      for( unsigned b=0; b < rec.out_block.size(); b++ )
+         m_gpu->get_global_memory()->read(rec.out_block[b] * m_bsize, m_bsize, &rec.out_data[b * m_bsize]);
+      rec.cycles = gpu_sim_cycle + gpu_tot_sim_cycle - m_start_cycle;
+      rec.insn = m_gpu->gpu_sim_insn + m_gpu->gpu_tot_sim_insn - m_start_insn;
+      rec.ctas = m_gpu->tot_issued_cta() - m_start_ctas;
+      m_n_recorded++;
+   } else {
+      stop_recording();
+   }
+}
+
+void kernel_memoizer::stop_recording()
+{
+   m_gpu->get_global_memory()->set_observer(NULL);
+   m_gpu->get_tex_memory()->set_observer(NULL);
+   m_gpu->get_surf_memory()->set_observer(NULL);
+   m_touched.clear();
+   m_recording_uid = 0;
+}
+
+void kernel_memoizer::print( FILE *fout ) const
+{
+   fprintf(fout, "memoized_kernels = %llu\n", m_n_memoized);
+   fprintf(fout, "memoized_kernel_cycles = %llu\n", m_memoized_cycles);
+   fprintf(fout, "memoization_records = %llu\n", m_n_recorded);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+
+#include "../tr1_hash_map.h"
+#include "../cuda-sim/memory.h"
+
+class gpgpu_sim;
+class kernel_info_t;
+
+// Kernel-level memoization.  A host-launched kernel that starts on an idle GPU
+// is fingerprinted by its entry function, grid and block dimensions and
+// parameter bytes.  While it runs, every global memory block it touches is
+// hashed before the first access and the blocks it writes are captured when
+// it retires.  A later launch with the same fingerprint whose touched blocks
+// still hash the same is replayed: the captured blocks are written back and
+// the cycle, instruction and CTA totals are advanced by the recorded amounts.
+class kernel_memoizer : public mem_touch_observer
+{
+public:
+   kernel_memoizer( gpgpu_sim *gpu );
+
+   // called while a host-launched kernel is at the front of its stream;
+   // returns true if the launch was replayed and the kernel can be retired
+   bool host_kernel_ready( class kernel_info_t *kernel );
+   void host_kernel_finished( class kernel_info_t *kernel );
+   // any other stream operation performed while recording (kernel is NULL
+   // for memory copies and events)
+   void operation_done( class kernel_info_t *kernel );
+
+   virtual void touch( memory_space *mem, mem_addr_t blk_idx, unsigned bsize, bool write );
+
+   void print( FILE *fout ) const;
+
+private:
+   struct touched_block {
+      unsigned long long hash; // contents before the kernel
+      bool written;
+   };
+   struct memo_record {
+      std::vector<mem_addr_t> in_block;
+      std::vector<unsigned long long> in_hash;
+      std::vector<mem_addr_t> out_block;
+      std::vector<unsigned char> out_data;
+      unsigned long long cycles;
+      unsigned long long insn;
+      unsigned long long ctas;
+   };
+
+   unsigned long long fingerprint( class kernel_info_t *kernel ) const;
+   unsigned long long block_hash( mem_addr_t blk_idx ) const;
+   void stop_recording();
+
+   gpgpu_sim *m_gpu;
+   tr1_hash_map<unsigned long long, memo_record> m_records;
+
+   unsigned m_last_uid;        // kernel currently at the front of its stream
+   unsigned m_recording_uid;   // 0 when not recording
+   bool m_recording_valid;
+   unsigned long long m_key;
+   unsigned long long m_start_cycle;
+   unsigned long long m_start_insn;
+   unsigned long long m_start_ctas;
+   unsigned long long m_start_child_param;
+   unsigned m_bsize;
+   tr1_hash_map<mem_addr_t, touched_block> m_touched;
+
+   unsigned long long m_n_memoized;
+   unsigned long long m_n_recorded;
+   unsigned long long m_memoized_cycles;
+};
@@ -0,0 +1,94 @@
+#include "sampler.h"
+
+#include <assert.h>
+#include <math.h>
+
+#include "gpu-sim.h"
+#include "../abstract_hardware_model.h"
+
+sim_sampler::sim_sampler( gpgpu_sim *gpu, unsigned period, unsigned detailed, bool warm_l2 )
+   : m_gpu(gpu), m_period(period), m_detailed(detailed), m_warm_l2(warm_l2),
+     m_n_host_kernels(0), m_pending(0), m_start_cycle(0), m_start_insn(0),
+     m_sample_cycles(0), m_sample_insn(0), m_ff_insn(0)
+{
+}
+
+bool sim_sampler::fast_forward( kernel_info_t *kernel )
+{
+   kernel_info_t *root = kernel;
+   while( root->get_parent() )
+      root = root->get_parent();
+   if( !root->m_sampled ) {
+      root->m_sampled = true;
+      root->m_fast_forward = (m_n_host_kernels++ % m_period) >= m_detailed;
+      if( !root->m_fast_forward && m_pending++ == 0 ) {
+         m_start_cycle = gpu_sim_cycle + gpu_tot_sim_cycle;
+         m_start_insn = m_gpu->gpu_sim_insn + m_gpu->gpu_tot_sim_insn;
+      }
+      printf("GPGPU-Sim: sampled simulation, kernel %d: \'%s\' %s\n", root->get_uid(), root->name().c_str(),
+             root->m_fast_forward ? "fast-forwarded" : "simulated in detail");
+   }
+   return root->m_fast_forward;
+}
+
+void sim_sampler::host_kernel_finished( kernel_info_t *kernel )
+{
+   if( !kernel->m_sampled || kernel->m_fast_forward )
+      return;
+   assert( m_pending > 0 );
+   if( --m_pending )
+      return;
+   unsigned long long cycles = gpu_sim_cycle + gpu_tot_sim_cycle - m_start_cycle;
+   unsigned long long insn = m_gpu->gpu_sim_insn + m_gpu->gpu_tot_sim_insn - m_start_insn;
+   if( cycles == 0 )
+      return;
+   m_sample_ipc.push_back( (double)insn / cycles );
+   m_sample_cycles += cycles;
+   m_sample_insn += insn;
+}
+
+void sim_sampler::functional_inst( const warp_inst_t &inst )
+{
+   m_ff_insn += inst.active_count();
+   if( !m_warm_l2 || inst.memory_op == no_memory_op || inst.space.get_type() != global_space )
+      return;
+   new_addr_type last_line = (new_addr_type)-1;
+   unsigned line_sz = m_gpu->getMemoryConfig()->m_L2_config.get_line_sz();
+   for( unsigned t=0; t < inst.warp_size(); t++ ) {
+      if( !inst.active(t) )
+         continue;
+      new_addr_type line = inst.get_addr(t) & ~(new_addr_type)(line_sz-1);
+      if( line != last_line )
+         m_gpu->warm_L2(line);
+      last_line = line;
+   }
+}
+
+void sim_sampler::print( FILE *fout ) const
+{
+   unsigned n = m_sample_ipc.size();
+   double ipc = m_sample_cycles ? (double)m_sample_insn / m_sample_cycles : 0;
+   unsigned long long simulated = gpu_sim_cycle + gpu_tot_sim_cycle;
+   double ff_cycles = ipc > 0 ? m_ff_insn / ipc : 0;
+
+   fprintf(fout, "sampled_detailed_samples = %u\n", n);
+   fprintf(fout, "sampled_detailed_cycle = %llu\n", m_sample_cycles);
+   fprintf(fout, "sampled_detailed_insn = %llu\n", m_sample_insn);
+   fprintf(fout, "sampled_ipc = %12.4f\n", ipc);
+   fprintf(fout, "sampled_fast_forward_insn = %llu\n", m_ff_insn);
+   fprintf(fout, "sampled_estimated_tot_sim_cycle = %.0f\n", simulated + ff_cycles);
+   if( n < 2 || ff_cycles == 0 ) {
+      fprintf(fout, "sampled_estimated_error = n/a\n");
+      return;
+   }
+   // 95% confidence interval of the mean sample IPC, applied to the extrapolated part
+   double mean = 0, var = 0;
+   for( unsigned i=0; i < n; i++ )
+      mean += m_sample_ipc[i];
+   mean /= n;
+   for( unsigned i=0; i < n; i++ )
+      var += (m_sample_ipc[i] - mean) * (m_sample_ipc[i] - mean);
+   var /= n - 1;
+   double rel = 1.96 * sqrt(var / n) / mean;
+   fprintf(fout, "sampled_estimated_error = +/-%.2f%%\n", 100.0 * rel * ff_cycles / (simulated + ff_cycles));
+}
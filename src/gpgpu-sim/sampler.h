@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdio.h>
+#include <vector>
+
+class gpgpu_sim;
+class kernel_info_t;
+class warp_inst_t;
+
+// Interval-sampled simulation.  Host-launched kernels are grouped into periods
+// of -sampling_period kernels; the first -sampling_detailed kernels of each
+// period run on the timing model and the rest are fast-forwarded through the
+// functional simulator, optionally warming the L2 tags with their global
+// accesses.  Device-launched kernels follow the mode of their host kernel.
+// Each run of detailed kernels is one sample; the cycles of the fast-forwarded
+// instructions are extrapolated from the IPC of the samples.
+class sim_sampler
+{
+public:
+   sim_sampler( gpgpu_sim *gpu, unsigned period, unsigned detailed, bool warm_l2 );
+
+   // true if the kernel is to be simulated functionally
+   bool fast_forward( class kernel_info_t *kernel );
+   void host_kernel_finished( class kernel_info_t *kernel );
+
+   // called for each warp instruction executed by the functional simulator
+   void functional_inst( const class warp_inst_t &inst );
+
+   void print( FILE *fout ) const;
+
+private:
+   gpgpu_sim *m_gpu;
+   unsigned m_period;
+   unsigned m_detailed;
+   bool m_warm_l2;
+
+   unsigned m_n_host_kernels;
+
+   // open sample
+   unsigned m_pending;             // detailed host kernels still running
+   unsigned long long m_start_cycle;
+   unsigned long long m_start_insn;
+
+   // closed samples
+   std::vector<double> m_sample_ipc;
+   unsigned long long m_sample_cycles;
+   unsigned long long m_sample_insn;
+
+   unsigned long long m_ff_insn;   // thread instructions fast-forwarded
+};
@@ -39,6 +39,16 @@ Scoreboard::Scoreboard( unsigned sid, unsigned n_warps )
 	//Initialize size of table
 	reg_table.resize(n_warps);
 	longopregs.resize(n_warps);
+	m_reserved.resize(n_warps);
+	m_longop.resize(n_warps);
+}
+
+void Scoreboard::restoreRegisters(unsigned wid, const std::set<unsigned> &regs, const std::set<unsigned> &longops)
+{
+	reg_table[wid] = regs;
+	longopregs[wid] = longops;
+	m_reserved[wid].assign(regs);
+	m_longop[wid].assign(longops);
 }
 
 // Print scoreboard contents
@@ -57,27 +67,29 @@ void Scoreboard::printContents() const
 
 void Scoreboard::reserveRegister(unsigned wid, unsigned regnum) 
 {
-	if( !(reg_table[wid].find(regnum) == reg_table[wid].end()) ){
+	if( m_reserved[wid].test(regnum) ){
 		printf("Error: trying to reserve an already reserved register (sid=%d, wid=%d, regnum=%d).", m_sid, wid, regnum);
         abort();
 	}
     SHADER_DPRINTF( SCOREBOARD,
                     "Reserved Register - warp:%d, reg: %d\n", wid, regnum );
 	reg_table[wid].insert(regnum);
+	m_reserved[wid].set(regnum);
 }
 
 // Unmark register as write-pending
 void Scoreboard::releaseRegister(unsigned wid, unsigned regnum) 
 {
-	if( !(reg_table[wid].find(regnum) != reg_table[wid].end()) ) 
+	if( !m_reserved[wid].test(regnum) ) 
         return;
     SHADER_DPRINTF( SCOREBOARD,
                     "Release register - warp:%d, reg: %d\n", wid, regnum );
 	reg_table[wid].erase(regnum);
+	m_reserved[wid].reset(regnum);
 }
 
 const bool Scoreboard::islongop (unsigned warp_id,unsigned regnum) {
-	return longopregs[warp_id].find(regnum) != longopregs[warp_id].end();
+	return m_longop[warp_id].test(regnum);
 }
 
 void Scoreboard::reserveRegisters(const class warp_inst_t* inst) 
@@ -107,6 +119,7 @@ void Scoreboard::reserveRegisters(const class warp_inst_t* inst)
                                 inst->warp_id(),
                                 inst->out[r] );
                 longopregs[inst->warp_id()].insert(inst->out[r]);
+                m_longop[inst->warp_id()].set(inst->out[r]);
             }
     	}
     }
@@ -123,6 +136,7 @@ void Scoreboard::releaseRegisters(const class warp_inst_t *inst)
                             inst->out[r] );
             releaseRegister(inst->warp_id(), inst->out[r]);
             longopregs[inst->warp_id()].erase(inst->out[r]);
+            m_longop[inst->warp_id()].reset(inst->out[r]);
         }
     }
 }
@@ -135,27 +149,15 @@ void Scoreboard::releaseRegisters(const class warp_inst_t *inst)
  **/ 
 bool Scoreboard::checkCollision( unsigned wid, const class inst_t *inst ) const
 {
-	// Get list of all input and output registers
-	std::set<int> inst_regs;
-
-	if(inst->out[0] > 0) inst_regs.insert(inst->out[0]);
-	if(inst->out[1] > 0) inst_regs.insert(inst->out[1]);
-	if(inst->out[2] > 0) inst_regs.insert(inst->out[2]);
-	if(inst->out[3] > 0) inst_regs.insert(inst->out[3]);
-	if(inst->in[0] > 0) inst_regs.insert(inst->in[0]);
-	if(inst->in[1] > 0) inst_regs.insert(inst->in[1]);
-	if(inst->in[2] > 0) inst_regs.insert(inst->in[2]);
-	if(inst->in[3] > 0) inst_regs.insert(inst->in[3]);
-	if(inst->pred > 0) inst_regs.insert(inst->pred);
-	if(inst->ar1 > 0) inst_regs.insert(inst->ar1);
-	if(inst->ar2 > 0) inst_regs.insert(inst->ar2);
-
-	// Check for collision, get the intersection of reserved registers and instruction registers
-	std::set<int>::const_iterator it2;
-	for ( it2=inst_regs.begin() ; it2 != inst_regs.end(); it2++ )
-		if(reg_table[wid].find(*it2) != reg_table[wid].end()) {
-			return true;
-		}
+	// Check for collision: is any input or output register of the instruction reserved
+	const reg_mask &reserved = m_reserved[wid];
+	for( unsigned r=0; r < 4; r++ ) {
+		if(inst->out[r] > 0 && reserved.test(inst->out[r])) return true;
+		if(inst->in[r] > 0 && reserved.test(inst->in[r])) return true;
+	}
+	if(inst->pred > 0 && reserved.test(inst->pred)) return true;
+	if(inst->ar1 > 0 && reserved.test(inst->ar1)) return true;
+	if(inst->ar2 > 0 && reserved.test(inst->ar2)) return true;
 	return false;
 }
 
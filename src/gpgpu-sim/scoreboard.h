@@ -36,6 +36,39 @@
 
 #include "../abstract_hardware_model.h"
 
+// set of register numbers as a bitmap, grown on demand; mirrors the
+// std::set tables below so the per-cycle hazard checks are bit tests
+class reg_mask {
+public:
+    bool test( unsigned reg ) const 
+    {
+        unsigned w = reg >> 6;
+        return w < m_bits.size() && ((m_bits[w] >> (reg & 63)) & 1);
+    }
+    void set( unsigned reg )
+    {
+        unsigned w = reg >> 6;
+        if( w >= m_bits.size() ) 
+            m_bits.resize(w + 1, 0);
+        m_bits[w] |= 1ULL << (reg & 63);
+    }
+    void reset( unsigned reg )
+    {
+        unsigned w = reg >> 6;
+        if( w < m_bits.size() ) 
+            m_bits[w] &= ~(1ULL << (reg & 63));
+    }
+    void assign( const std::set<unsigned> &regs )
+    {
+        m_bits.assign(m_bits.size(), 0);
+        for( std::set<unsigned>::const_iterator r = regs.begin(); r != regs.end(); r++ ) 
+            set(*r);
+    }
+
+private:
+    std::vector<unsigned long long> m_bits;
+};
+
 class Scoreboard {
 public:
     Scoreboard( unsigned sid, unsigned n_warps );
@@ -49,8 +82,10 @@ public:
     void printContents() const;
     const bool islongop(unsigned warp_id, unsigned regnum);
     //Andrew
-    std::vector< std::set<unsigned> > &getRegTable(){return reg_table;};
-    std::vector< std::set<unsigned> > &getLongOpRegs(){return longopregs;};
+    const std::vector< std::set<unsigned> > &getRegTable() const {return reg_table;};
+    const std::vector< std::set<unsigned> > &getLongOpRegs() const {return longopregs;};
+    // reinstall the pending writes of a warp that is switched back in
+    void restoreRegisters(unsigned wid, const std::set<unsigned> &regs, const std::set<unsigned> &longops);
 
 private:
     void reserveRegister(unsigned wid, unsigned regnum);
@@ -63,6 +98,10 @@ private:
     std::vector< std::set<unsigned> > reg_table;
     //Register that depend on a long operation (global, local or tex memory)
     std::vector< std::set<unsigned> > longopregs;
+
+    // bitmap copies of reg_table and longopregs, per warp
+    std::vector< reg_mask > m_reserved;
+    std::vector< reg_mask > m_longop;
 };
 
 
@@ -330,10 +330,12 @@ shader_core_ctx::shader_core_ctx( class gpgpu_sim *gpu,
 
 	next_dispatchable_cycle = 0;
 	now_context_switching = false;
+	m_sleeping = false;
 }
 
 void shader_core_ctx::reinit(unsigned start_thread, unsigned end_thread, bool reset_not_completed ) 
 {
+	wake();
 	if( reset_not_completed ) {
 		m_not_completed = 0;
 		m_active_threads.reset();
@@ -384,8 +386,8 @@ void shader_core_ctx::init_warps( unsigned cta_id, unsigned start_thread, unsign
 			m_simt_stack[i]->m_cta_id = cta_id;
 			m_warp[i].m_global_cta_id = m_thread[start_thread]->get_block_idx();
 			m_simt_stack[i]->m_global_cta_id = m_thread[start_thread]->get_block_idx();
-			m_warp[i].m_kernel_id = m_thread[start_thread]->m_kernel.get_uid();
-			m_simt_stack[i]->m_kernel_id = m_thread[start_thread]->m_kernel.get_uid();
+			m_warp[i].m_kernel_id = m_thread[start_thread]->get_kernel().get_uid();
+			m_simt_stack[i]->m_kernel_id = m_thread[start_thread]->get_kernel().get_uid();
 		}
 	}
 }
@@ -730,14 +732,14 @@ void shader_core_ctx::fetch()
 			if( !m_warp[warp_id].functional_done() && !m_warp[warp_id].imiss_pending() && m_warp[warp_id].ibuffer_empty() && !m_warp[warp_id].done_exit()) {
 				//Andrew: Forced not to fetch inst.
 				unsigned global_cta_id = m_warp[warp_id].m_global_cta_id;
-				unsigned switched = m_thread[warp_id * 32]->m_kernel.block_state[global_cta_id].switched;
-				unsigned preempted = m_thread[warp_id * 32]->m_kernel.block_state[global_cta_id].preempted;
-				unsigned issuable = (gpu_sim_cycle>=m_thread[warp_id * 32]->m_kernel.block_state[global_cta_id].time_stamp_switching_issue) ? 1:0;
+				unsigned switched = m_thread[warp_id * 32]->get_kernel().block_state[global_cta_id].switched;
+				unsigned preempted = m_thread[warp_id * 32]->get_kernel().block_state[global_cta_id].preempted;
+				unsigned issuable = (gpu_sim_cycle>=m_thread[warp_id * 32]->get_kernel().block_state[global_cta_id].time_stamp_switching_issue) ? 1:0;
 
                                 /* not fetching parent threads if param buffer is full */
 				extern bool param_buffer_full; 
                                 extern std::list<unsigned int> target_parent_list;
-                                bool target_parent_kernel = (std::find(target_parent_list.begin(), target_parent_list.end(), m_thread[warp_id * 32]->m_kernel.get_uid()) != target_parent_list.end()) ? true : false;
+                                bool target_parent_kernel = (std::find(target_parent_list.begin(), target_parent_list.end(), m_thread[warp_id * 32]->get_kernel().get_uid()) != target_parent_list.end()) ? true : false;
 //				if (param_buffer_full && buf_full_stall)
 //				   printf("On-chip buffer is full, postpone warp %d from kernel\n");
 //                                buf_full_stall &= param_buffer_full;
@@ -781,7 +783,7 @@ void shader_core_ctx::fetch()
 /*				   printf("core %d warp %d [%d, %d] blocked: %c%c%c%c%c\n", 
 					 this->m_sid, 
 					 warp_id, 
-					 m_thread[warp_id*32]->m_kernel.get_uid(), 
+					 m_thread[warp_id*32]->get_kernel().get_uid(), 
 					 global_cta_id,
 					 switched ? 's':' ',
 					 preempted ? 'p':' ',
@@ -903,14 +905,19 @@ void scheduler_unit::order_lrr( std::vector< T >& result_list,
  * The explanation of the additional parameters (beyond order_lrr) explains the further extensions.
  * @param ordering: An enum that determines how the age function will be treated in prioritization
  *                  see the definition of OrderingType.
- * @param priority_function: This function is used to sort the input_list.  It is passed to stl::sort as
- *                           the sorting fucntion. So, if you wanted to sort a list of integer warp_ids
- *                           with the oldest warps having the most priority, then the priority_function
- *                           would compare the age of the two warps.
+ * @param sorted_list: Persistent buffer owned by the caller that holds input_list in the order
+ *                     produced by the previous call.  Priorities change little between cycles,
+ *                     so it is re-sorted in place with an insertion sort, which is linear when
+ *                     almost nothing moved and needs no allocation.
+ * @param priority_function: This function is used to sort the input_list.  So, if you wanted to
+ *                           sort a list of integer warp_ids with the oldest warps having the most
+ *                           priority, then the priority_function would compare the age of the two
+ *                           warps.
  */
 	template < class T >
 void scheduler_unit::order_by_priority( std::vector< T >& result_list,
 		const typename std::vector< T >& input_list,
+		typename std::vector< T >& sorted_list,
 		const typename std::vector< T >::const_iterator& last_issued_from_input,
 		unsigned num_warps_to_add,
 		OrderingType ordering,
@@ -918,13 +925,23 @@ void scheduler_unit::order_by_priority( std::vector< T >& result_list,
 {
 	assert( num_warps_to_add <= input_list.size() );
 	result_list.clear();
-	typename std::vector< T > temp = input_list;
+	if ( sorted_list.size() != input_list.size() ) {
+		sorted_list = input_list;
+	}
+	typename std::vector< T > &temp = sorted_list;
+	for ( unsigned i = 1; i < temp.size(); ++i ) {
+		T value = temp[i];
+		unsigned j = i;
+		for ( ; j > 0 && priority_func( value, temp[j-1] ); --j ) {
+			temp[j] = temp[j-1];
+		}
+		temp[j] = value;
+	}
 
 	if ( ORDERING_GREEDY_THEN_PRIORITY_FUNC == ordering ) {
 		T greedy_value = *last_issued_from_input;
 		result_list.push_back( greedy_value );
 
-		std::sort( temp.begin(), temp.end(), priority_func );
 		typename std::vector< T >::iterator iter = temp.begin();
 		for ( unsigned count = 0; count < num_warps_to_add; ++count, ++iter ) {
 			if ( *iter != greedy_value ) {
@@ -932,7 +949,6 @@ void scheduler_unit::order_by_priority( std::vector< T >& result_list,
 			}
 		}
 	} else if ( ORDERED_PRIORITY_FUNC_ONLY == ordering ) {
-		std::sort( temp.begin(), temp.end(), priority_func );
 		typename std::vector< T >::iterator iter = temp.begin();
 		for ( unsigned count = 0; count < num_warps_to_add; ++count, ++iter ) {
 			result_list.push_back( *iter );
@@ -943,6 +959,28 @@ void scheduler_unit::order_by_priority( std::vector< T >& result_list,
 	}
 }
 
+void scheduler_unit::sample_dps( unsigned n )
+{
+	extern bool g_child_aware_smk_scheduling;
+	if(g_child_aware_smk_scheduling){
+	    extern unsigned long long DPS[4];
+	    extern unsigned long long total_num_offchip_metadata;
+	    extern unsigned int g_kernel_queue_entry_used;
+	    extern bool tdq_full, undispatched_device_TBs;
+	    DPS[0] += n;
+	    if( tdq_full ) DPS[3] += n;
+	    //else if( child_consuming_rate_higher ) DPS[2]++;
+	    else if( (total_num_offchip_metadata > 0 || g_kernel_queue_entry_used > 0) && undispatched_device_TBs ) DPS[2] += n;
+	    else DPS[1] += n;
+	}
+}
+
+void scheduler_unit::idle_cycle( unsigned n )
+{
+	sample_dps(n);
+	m_stats->shader_cycle_distro[0] += n; // idle
+}
+
 void scheduler_unit::cycle()
 {
 	SCHED_DPRINTF( "scheduler_unit::cycle()\n" );
@@ -959,14 +997,7 @@ void scheduler_unit::cycle()
 	extern unsigned long long potential_child_kernels;
 	extern bool undispatched_device_TBs;
 
-	if(g_child_aware_smk_scheduling){
-	    extern unsigned long long DPS[4];
-	    DPS[0]++;
-	    if( tdq_full ) DPS[3]++;
-	    //else if( child_consuming_rate_higher ) DPS[2]++;
-	    else if( (total_num_offchip_metadata > 0 || g_kernel_queue_entry_used > 0) && undispatched_device_TBs ) DPS[2]++;
-	    else DPS[1]++;
-	}
+	sample_dps();
 
 	order_warps();
 
@@ -975,6 +1006,7 @@ void scheduler_unit::cycle()
 //	    printf("Cycle %llu: SM warp scheduler prioritizes child warps\n", gpu_sim_cycle+gpu_tot_sim_cycle);
 	    order_by_priority( m_next_cycle_prioritized_warps,
 		    m_all_warps,
+		    m_all_warps_by_priority,
 //		    m_supervised_warps,
 		    m_last_supervised_issued,
 		    m_all_warps.size(),
@@ -1236,6 +1268,7 @@ void gto_scheduler::order_warps()
 {
 	order_by_priority( m_next_cycle_prioritized_warps,
 			m_supervised_warps,
+			m_supervised_warps_by_priority,
 			m_last_supervised_issued,
 			m_supervised_warps.size(),
 			ORDERING_GREEDY_THEN_PRIORITY_FUNC,
@@ -1246,6 +1279,7 @@ void gtcto_scheduler::order_warps()
 {
 	order_by_priority( m_next_cycle_prioritized_warps,
 			m_supervised_warps,
+			m_supervised_warps_by_priority,
 			m_last_supervised_issued,
 			m_supervised_warps.size(),
 			ORDERING_GREEDY_THEN_PRIORITY_FUNC,
@@ -1259,12 +1293,11 @@ two_level_active_scheduler::do_on_warp_issued( unsigned warp_id,
 {
 	scheduler_unit::do_on_warp_issued( warp_id, num_issued, prioritized_iter );
 	if ( SCHEDULER_PRIORITIZATION_LRR == m_inner_level_prioritization ) {
-		std::vector< shd_warp_t* > new_active; 
-		order_lrr( new_active,
+		order_lrr( m_new_active,
 				m_next_cycle_prioritized_warps,
 				prioritized_iter,
 				m_next_cycle_prioritized_warps.size() );
-		m_next_cycle_prioritized_warps = new_active;
+		m_next_cycle_prioritized_warps = m_new_active; // same size, no reallocation
 	} else {
 		fprintf( stderr,
 				"Unimplemented m_inner_level_prioritization: %d\n",
@@ -1348,6 +1381,7 @@ void swl_scheduler::order_warps()
 	if ( SCHEDULER_PRIORITIZATION_GTO == m_prioritization ) {
 		order_by_priority( m_next_cycle_prioritized_warps,
 				m_supervised_warps,
+				m_supervised_warps_by_priority,
 				m_last_supervised_issued,
 				MIN( m_num_warps_to_limit, m_supervised_warps.size() ),
 				ORDERING_GREEDY_THEN_PRIORITY_FUNC,
@@ -2089,6 +2123,26 @@ void ldst_unit::writeback()
 	}
 }
 
+bool ldst_unit::idle() const
+{
+	if( !m_dispatch_reg->empty() || m_dispatch_reg->has_dispatch_delay() || !m_next_wb.empty() || m_next_global )
+		return false;
+	for( unsigned stage=0; stage < m_pipeline_depth; stage++ )
+		if( !m_pipeline_reg[stage]->empty() )
+			return false;
+	if( !m_response_fifo.empty() || !m_L1T->quiescent() || !m_L1C->quiescent() )
+		return false;
+	return !m_L1D || m_L1D->quiescent();
+}
+
+// what n cycle() amount to while idle() holds
+void ldst_unit::idle_cycle( unsigned n )
+{
+	m_operand_collector->idle_step(n);
+	m_L1C->idle_cycle(n);
+	if( m_L1D ) m_L1D->idle_cycle(n);
+}
+
 unsigned ldst_unit::clock_multiplier() const
 { 
 	return m_config->mem_warp_parts; 
@@ -2769,46 +2823,61 @@ void shader_core_ctx::display_pipeline(FILE *fout, int print_mem, int mask ) con
 
 }
 
-unsigned int shader_core_config::max_cta( const kernel_info_t &k ) const
+const kernel_occupancy_t &shader_core_config::occupancy( const kernel_info_t &k ) const
 {
-	unsigned threads_per_cta  = k.threads_per_cta();
-	const class function_info *kernel = k.entry();
-	unsigned int padded_cta_size = threads_per_cta;
+	kernel_occupancy_t &occ = k.entry()->occupancy(k.threads_per_cta());
+	if (occ.config_epoch == gpgpu_occupancy_epoch) 
+		return occ;
+
+	unsigned int padded_cta_size = k.threads_per_cta();
 	if (padded_cta_size%warp_size) 
 		padded_cta_size = ((padded_cta_size/warp_size)+1)*(warp_size);
+	const struct gpgpu_ptx_sim_kernel_info *kernel_info = ptx_sim_kernel_info(k.entry());
 
-	//Limit by n_threads/shader
-	unsigned int result_thread = n_thread_per_shader / padded_cta_size;
+	occ.config_epoch = gpgpu_occupancy_epoch;
+	occ.padded_cta_size = padded_cta_size;
+	occ.smem_per_cta = kernel_info->smem;
+	//registers are allocated in multiples of 4 per thread
+	occ.regs_per_cta = padded_cta_size * ((kernel_info->regs+3)&~3);
 
-	const struct gpgpu_ptx_sim_kernel_info *kernel_info = ptx_sim_kernel_info(kernel);
+	//Limit by n_threads/shader
+	occ.cta_by_threads = n_thread_per_shader / padded_cta_size;
 
 	//Limit by shmem/shader
-	unsigned int result_shmem = (unsigned)-1;
+	occ.cta_by_shmem = (unsigned)-1;
 	if (kernel_info->smem > 0)
-		result_shmem = gpgpu_shmem_size / kernel_info->smem;
+		occ.cta_by_shmem = gpgpu_shmem_size / kernel_info->smem;
 
-	//Limit by register count, rounded up to multiple of 4.
-	unsigned int result_regs = (unsigned)-1;
+	//Limit by register count
+	occ.cta_by_regs = (unsigned)-1;
 	if (kernel_info->regs > 0)
-		result_regs = gpgpu_shader_registers / (padded_cta_size * ((kernel_info->regs+3)&~3));
+		occ.cta_by_regs = gpgpu_shader_registers / occ.regs_per_cta;
 
 	//Limit by CTA
-	unsigned int result_cta = max_cta_per_core;
+	occ.cta_by_limit = max_cta_per_core;
 
-	unsigned result = result_thread;
-	result = gs_min2(result, result_shmem);
-	result = gs_min2(result, result_regs);
-	result = gs_min2(result, result_cta);
+	occ.max_cta = occ.cta_by_threads;
+	occ.max_cta = gs_min2(occ.max_cta, occ.cta_by_shmem);
+	occ.max_cta = gs_min2(occ.max_cta, occ.cta_by_regs);
+	occ.max_cta = gs_min2(occ.max_cta, occ.cta_by_limit);
+	return occ;
+}
+
+unsigned int shader_core_config::max_cta( const kernel_info_t &k ) const
+{
+	const kernel_occupancy_t &occ = occupancy(k);
+	const struct gpgpu_ptx_sim_kernel_info *kernel_info = ptx_sim_kernel_info(k.entry());
+	unsigned result = occ.max_cta;
 
 	static const struct gpgpu_ptx_sim_kernel_info* last_kinfo = NULL;
 	if (last_kinfo != kernel_info) {   //Only print out stats if kernel_info struct changes
 		last_kinfo = kernel_info;
 		printf ("GPGPU-Sim uArch: CTA/core = %u, limited by:", result);
-		if (result == result_thread) printf (" threads");
-		if (result == result_shmem) printf (" shmem");
-		if (result == result_regs) printf (" regs");
-		if (result == result_cta) printf (" cta_limit");
-		printf (", resource usage (%0.3f, %0.3f, %0.3f, %0.3f)\n", (float)padded_cta_size / n_thread_per_shader, (float)kernel_info->smem / gpgpu_shmem_size, (float)(padded_cta_size * ((kernel_info->regs+3)&~3)) / gpgpu_shader_registers, (float)1/max_cta_per_core);
+		if (result == occ.cta_by_threads) printf (" threads");
+		if (result == occ.cta_by_shmem) printf (" shmem");
+		if (result == occ.cta_by_regs) printf (" regs");
+		if (result == occ.cta_by_limit) printf (" cta_limit");
+		printf (", resource usage (%0.3f, %0.3f, %0.3f, %0.3f)\n", (float)occ.padded_cta_size / n_thread_per_shader, (float)occ.smem_per_cta / gpgpu_shmem_size, (float)occ.regs_per_cta / gpgpu_shader_registers, (float)1/max_cta_per_core);
 	}
 
 	//gpu_max_cta_per_shader is limited by number of CTAs if not enough to keep all cores busy    
@@ -2829,6 +2898,10 @@ unsigned int shader_core_config::max_cta( const kernel_info_t &k ) const
 
 void shader_core_ctx::cycle()
 {
+	if( m_sleeping ) {
+		sleep_cycle();
+		return;
+	}
 	m_stats->shader_cycles[m_sid]++;
 	writeback();
 	//fprintf(stdout, "after wb\n");
@@ -2843,6 +2916,52 @@ void shader_core_ctx::cycle()
 	fetch();
 	//fprintf(stdout, "after fetch\n");
 	inc_shader_warp_activity();
+	if( m_config->gpgpu_core_sleep )
+		m_sleeping = can_sleep();
+}
+
+// A core can sleep once it has no threads and every stage, function unit and
+// L1 is drained: from then on cycle() only bumps the idle statistics and
+// rotates a few arbiters, which sleep_cycle() does directly.  Anything that
+// gives the core work again (CTA issue, fill from the interconnect) wakes it.
+bool shader_core_ctx::can_sleep()
+{
+	if( m_not_completed || m_n_active_cta || m_occupied_hwtid.any() || now_context_switching )
+		return false;
+	if( m_inst_fetch_buffer.m_valid || !m_L1I->quiescent() )
+		return false;
+	for( unsigned i=0; i < m_pipeline_reg.size(); i++ )
+		if( m_pipeline_reg[i].has_ready() )
+			return false;
+	for( unsigned i=0; i < num_result_bus; i++ )
+		if( m_result_bus[i]->any() )
+			return false;
+	for( unsigned n=0; n < m_num_function_units; n++ )
+		if( !m_fu[n]->idle() )
+			return false;
+	for( unsigned i=0; i < schedulers.size(); i++ )
+		if( !schedulers[i]->idle_order_is_stateless() )
+			return false;
+	return true;
+}
+
+void shader_core_ctx::sleep_cycle( unsigned n )
+{
+	m_stats->shader_cycles[m_sid] += n;
+	// writeback()
+	unsigned max_committed_thread_instructions=m_config->warp_size * (m_config->pipe_widths[EX_WB]);
+	m_stats->m_pipeline_duty_cycle[m_sid]=((float)(m_stats->m_num_sim_insn[m_sid]-m_stats->m_last_num_sim_insn[m_sid]))/max_committed_thread_instructions;
+	m_stats->m_last_num_sim_insn[m_sid] = m_stats->m_num_sim_insn[m_sid];
+	m_stats->m_last_num_sim_winsn[m_sid] = m_stats->m_num_sim_winsn[m_sid];
+	if( n > 1 ) 
+		m_stats->m_pipeline_duty_cycle[m_sid] = 0; // nothing retires after the first one
+	// execute()
+	m_ldst_unit->idle_cycle( n * m_ldst_unit->clock_multiplier() );
+	// issue()
+	for( unsigned i=0; i < schedulers.size(); i++ )
+		schedulers[i]->idle_cycle(n);
+	// fetch()
+	m_L1I->idle_cycle(n);
 }
 
 // Flushes all content of the cache to memory
@@ -2853,10 +2972,55 @@ void shader_core_ctx::cache_flush()
 }
 
 // modifiers
-std::list<opndcoll_rfu_t::op_t> opndcoll_rfu_t::arbiter_t::allocate_reads() 
+unsigned opndcoll_rfu_t::arbiter_t::allocate_reads() 
 {
-	std::list<op_t> result;  // a list of registers that (a) are in different register banks, (b) do not go to the same operand collector
+	// grants registers that (a) are in different register banks, (b) do not go to the same operand collector
+
+	// Wavefront allocator from booksim over the bank x collector request
+	// matrix.  Diagonal p pairs bank i with collector (_pri+p+i)%_square and
+	// the diagonals are visited in order, so a collector goes to the
+	// requesting bank whose request lies on the earliest diagonal.  A bank
+	// only ever requests the collector at the front of its queue, so that
+	// choice is made directly instead of sweeping the whole matrix.
+	if( m_legacy ) 
+		return allocate_reads_legacy();
+
+	unsigned _square = ( m_num_banks > m_num_collectors ) ? m_num_banks : m_num_collectors;
+	assert(_square > 0);
+	unsigned _pri = m_last_cu;
+
+	for( unsigned i=0; i<m_num_banks; i++) {
+		if( m_queue[i].empty() || m_allocated_bank[i].is_write() ) 
+			continue; // write gets priority
+		unsigned oc_id = m_queue[i].front().get_oc_id();
+		assert( oc_id < m_num_collectors );
+		unsigned diag = ( oc_id + 2*_square - _pri - i ) % _square;
+		if( m_grant_bank[oc_id] == -1 || diag < m_grant_diag[oc_id] ) {
+			m_grant_bank[oc_id] = i;
+			m_grant_diag[oc_id] = diag;
+		}
+	}
+
+	// Round-robin the priority diagonal
+	m_last_cu = ( _pri + 1 ) % _square;
+
+	unsigned n=0;
+	for( unsigned i=0; i < m_num_banks; i++ ) {
+		if( m_queue[i].empty() || m_allocated_bank[i].is_write() ) 
+			continue;
+		unsigned oc_id = m_queue[i].front().get_oc_id();
+		if( m_grant_bank[oc_id] == (int)i ) {
+			m_granted[n++] = m_queue[i].front();
+			m_queue[i].pop_front();
+			m_grant_bank[oc_id] = -1; // every winner is popped here, leaving the table clear
+		}
+	}
+	return n;
+}
 
+// the original sweep of the whole request matrix, kept for comparison with allocate_reads()
+unsigned opndcoll_rfu_t::arbiter_t::allocate_reads_legacy() 
+{
 	int input;
 	int output;
 	int _inputs = m_num_banks;
@@ -2920,18 +3084,16 @@ std::list<opndcoll_rfu_t::op_t> opndcoll_rfu_t::arbiter_t::allocate_reads()
 	/// <--- end code from booksim
 
 	m_last_cu = _pri;
+	unsigned n=0;
 	for( unsigned i=0; i < m_num_banks; i++ ) {
 		if( _inmatch[i] != -1 ) {
 			if( !m_allocated_bank[i].is_write() ) {
-				unsigned bank = (unsigned)i;
-				op_t &op = m_queue[bank].front();
-				result.push_back(op);
-				m_queue[bank].pop_front();
+				m_granted[n++] = m_queue[i].front();
+				m_queue[i].pop_front();
 			}
 		}
 	}
-
-	return result;
+	return n;
 }
 
 barrier_set_t::barrier_set_t(shader_core_ctx *shader,unsigned max_warps_per_core, unsigned max_cta_per_core, unsigned max_barriers_per_cta, unsigned warp_size)
@@ -3185,6 +3347,7 @@ bool shader_core_ctx::fetch_unit_response_buffer_full() const
 
 void shader_core_ctx::accept_fetch_response( mem_fetch *mf )
 {
+	wake();
 	mf->set_status(IN_SHADER_FETCHED,gpu_sim_cycle+gpu_tot_sim_cycle);
 	m_L1I->fill(mf,gpu_sim_cycle+gpu_tot_sim_cycle);
 }
@@ -3196,6 +3359,7 @@ bool shader_core_ctx::ldst_unit_response_buffer_full() const
 
 void shader_core_ctx::accept_ldst_unit_response(mem_fetch * mf) 
 {
+	wake();
 	m_ldst_unit->fill(mf);
 }
 
@@ -3310,14 +3474,17 @@ void shd_warp_t::print_ibuffer( FILE *fout ) const
 }
 
 void opndcoll_rfu_t::add_cu_set(unsigned set_id, unsigned num_cu, unsigned num_dispatch){
+	assert(num_cu <= 64); // one bit per CU in m_cu_set_collected
+	m_cu_set_collected[set_id] = 0;
 	m_cus[set_id].reserve(num_cu); //this is necessary to stop pointers in m_cu from being invalid do to a resize;
 	for (unsigned i = 0; i < num_cu; i++) {
 		m_cus[set_id].push_back(collector_unit_t());
 		m_cu.push_back(&m_cus[set_id].back());
+		m_cu_set_pos.push_back(std::make_pair(set_id,i));
 	}
 	// for now each collector set gets dedicated dispatch units.
 	for (unsigned i = 0; i < num_dispatch; i++) {
-		m_dispatch_units.push_back(dispatch_unit_t(&m_cus[set_id]));
+		m_dispatch_units.push_back(dispatch_unit_t(&m_cus[set_id], &m_cu_set_collected[set_id]));
 	}
 }
 
@@ -3338,7 +3505,10 @@ void opndcoll_rfu_t::add_port(port_vector_t & input, port_vector_t & output, uin
 void opndcoll_rfu_t::init( unsigned num_banks, shader_core_ctx *shader )
 {
 	m_shader=shader;
-	m_arbiter.init(m_cu.size(),num_banks);
+	bool legacy = shader->get_config()->gpgpu_operand_collector_legacy_arbiter;
+	m_arbiter.init(m_cu.size(),num_banks,legacy);
+	for( unsigned d=0; d < m_dispatch_units.size(); d++ ) 
+		m_dispatch_units[d].set_legacy(legacy);
 	//for( unsigned n=0; n<m_num_ports;n++ ) 
 	//    m_dispatch_units[m_output[n]].init( m_num_collector_units[n] );
 	m_num_banks = num_banks;
@@ -3348,7 +3518,8 @@ void opndcoll_rfu_t::init( unsigned num_banks, shader_core_ctx *shader )
 	assert( (m_bank_warp_shift == 5) || (m_warp_size != 32) );
 
 	for( unsigned j=0; j<m_cu.size(); j++) {
-		m_cu[j]->init(j,num_banks,m_bank_warp_shift,shader->get_config(),this);
+		unsigned set_id = m_cu_set_pos[j].first;
+		m_cu[j]->init(j,num_banks,m_bank_warp_shift,shader->get_config(),this,&m_cu_set_collected[set_id],m_cu_set_pos[j].second);
 	}
 	m_initialized=true;
 }
@@ -3448,20 +3619,15 @@ void opndcoll_rfu_t::allocate_cu( unsigned port_num )
 
 void opndcoll_rfu_t::allocate_reads()
 {
-	// process read requests that do not have conflicts
-	std::list<op_t> allocated = m_arbiter.allocate_reads();
-	std::map<unsigned,op_t> read_ops;
-	for( std::list<op_t>::iterator r=allocated.begin(); r!=allocated.end(); r++ ) {
-		const op_t &rr = *r;
-		unsigned reg = rr.get_reg();
-		unsigned wid = rr.get_wid();
-		unsigned bank = register_bank(reg,wid,m_num_banks,m_bank_warp_shift);
-		m_arbiter.allocate_for_read(bank,rr);
-		read_ops[bank] = rr;
-	}
-	std::map<unsigned,op_t>::iterator r;
-	for(r=read_ops.begin();r!=read_ops.end();++r ) {
-		op_t &op = r->second;
+	// process read requests that do not have conflicts; the grants come one
+	// per bank in bank order
+	unsigned n_allocated = m_arbiter.allocate_reads();
+	for( unsigned r=0; r < n_allocated; r++ ) {
+		const op_t &rr = m_arbiter.granted(r);
+		m_arbiter.allocate_for_read(rr.get_bank(),rr);
+	}
+	for( unsigned r=0; r < n_allocated; r++ ) {
+		const op_t &op = m_arbiter.granted(r);
 		unsigned cu = op.get_oc_id();
 		unsigned operand = op.get_operand();
 		m_cu[cu]->collect_operand(operand);
@@ -3506,9 +3672,13 @@ void opndcoll_rfu_t::collector_unit_t::init( unsigned n,
 		unsigned num_banks, 
 		unsigned log2_warp_size,
 		const core_config *config,
-		opndcoll_rfu_t *rfu ) 
+		opndcoll_rfu_t *rfu,
+		unsigned long long *collected,
+		unsigned set_idx ) 
 { 
 	m_rfu=rfu;
+	m_collected=collected;
+	m_set_idx=set_idx;
 	m_cuid=n; 
 	m_num_banks=num_banks;
 	assert(m_warp==NULL); 
@@ -3535,8 +3705,11 @@ bool opndcoll_rfu_t::collector_unit_t::allocate( register_set* pipeline_reg_set,
 		}
 		//move_warp(m_warp,*pipeline_reg);
 		pipeline_reg_set->move_out_to(m_warp);
+		if( m_not_ready.none() ) 
+			*m_collected |= 1ULL << m_set_idx;
 		return true;
 	}
+	*m_collected |= 1ULL << m_set_idx; // allocated with no operands to collect
 	return false;
 }
 
@@ -3546,6 +3719,7 @@ void opndcoll_rfu_t::collector_unit_t::dispatch()
 	//move_warp(*m_output_register,m_warp);
 	m_output_register->move_in(m_warp);
 	m_free=true;
+	*m_collected &= ~(1ULL << m_set_idx);
 	m_output_register = NULL;
 	for( unsigned i=0; i<MAX_REG_OPERANDS*2;i++)
 		m_src_op[i].reset();
@@ -3585,6 +3759,31 @@ void simt_core_cluster::core_cycle()
 	}
 }
 
+bool simt_core_cluster::idle( bool core_cycled ) const
+{
+	if( !m_response_fifo.empty() || get_not_completed() )
+		return false;
+	if( core_cycled ) {
+		for( unsigned i=0; i < m_config->n_simt_cores_per_cluster; i++ ) 
+			if( !m_core[i]->sleeping() )
+				return false;
+	}
+	return true;
+}
+
+void simt_core_cluster::idle_core_cycle( unsigned n )
+{
+	if( n == 0 ) 
+		return;
+	for( unsigned i=0; i < m_config->n_simt_cores_per_cluster; i++ ) 
+		m_core[i]->sleep_cycle(n);
+
+	if (m_config->simt_core_sim_order == 1) {
+		for( unsigned r = n % m_core_sim_order.size(); r > 0; r-- ) 
+			m_core_sim_order.splice(m_core_sim_order.end(), m_core_sim_order, m_core_sim_order.begin()); 
+	}
+}
+
 void simt_core_cluster::reinit()
 {
 	for( unsigned i=0; i < m_config->n_simt_cores_per_cluster; i++ ) 
@@ -3678,7 +3877,7 @@ unsigned simt_core_cluster::issue_block2core() {
 
       int switch_issued = 0;
       extern bool param_buffer_full;
-      for(unsigned n=0; n < m_gpu->m_running_kernels.size(); n++ ) {
+      for(int n=m_gpu->next_running_slot(0); n >= 0; n=m_gpu->next_running_slot(n+1) ) {
 	 kernel = m_gpu->m_running_kernels[n];
 	 //if(kernel && !g_dyn_child_thread_consolidation){
 	 if(kernel && !param_buffer_full/*&& !g_simultaneous_multikernel_within_SM*/){
@@ -3930,13 +4129,7 @@ unsigned long long shader_core_ctx::switching_latency( kernel_info_t &k )
 {
     extern bool g_context_switching_overhead;
     if (g_context_switching_overhead){
-	unsigned threads_per_cta  = k.threads_per_cta();
-	const class function_info *kernel = k.entry();
-	unsigned int padded_cta_size = threads_per_cta;
-	if (padded_cta_size%m_config->warp_size) 
-		padded_cta_size = ((padded_cta_size/m_config->warp_size)+1)*(m_config->warp_size);
-
-	const struct gpgpu_ptx_sim_kernel_info *kernel_info = ptx_sim_kernel_info(kernel);
+	const kernel_occupancy_t &occ = m_config->occupancy(k);
 	unsigned long long bandwidth;
 	unsigned context;
 	double time, perShaderBandwidth;
@@ -3951,7 +4144,7 @@ unsigned long long shader_core_ctx::switching_latency( kernel_info_t &k )
 	bandwidth = numMem * 8 /*64 bit per channel */ * memFreq * freqRatio;
 //	bandwidth = 4/*5*//*6*/ * 2/*4*//*2*/ * 2/*4*/ * 1500000000llu/*2600000000llu*//*1848000000llu*/ * 2;  
 	perShaderBandwidth = (double) bandwidth / numShader;
-	context = ((unsigned)kernel_info->smem + ((padded_cta_size * ((kernel_info->regs+3)&~3))*4)) * 2; //switch out and in
+	context = (occ.smem_per_cta + (occ.regs_per_cta*4)) * 2; //switch out and in
 	time = (double) context / perShaderBandwidth;
 	latency = (unsigned long long)(time * shaderFreq);
 
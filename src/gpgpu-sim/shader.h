@@ -397,6 +397,10 @@ class scheduler_unit { //this can be copied freely, so can be used in std contai
 		// all the derived schedulers.  The scheduler's behaviour can be
 		// modified by changing the contents of the m_next_cycle_prioritized_warps list.
 		void cycle();
+		// n cycle() on a core without warps: only the issue stall statistics change
+		void idle_cycle( unsigned n = 1 );
+		// false if order_warps() changes the scheduler state even when no warp can issue
+		virtual bool idle_order_is_stateless() const { return true; }
 
 		// These are some common ordering fucntions that the
 		// higher order schedulers can take advantage of
@@ -419,6 +423,7 @@ class scheduler_unit { //this can be copied freely, so can be used in std contai
 		template < typename U >
 			void order_by_priority( std::vector< U >& result_list,
 					const typename std::vector< U >& input_list,
+					typename std::vector< U >& sorted_list,
 					const typename std::vector< U >::const_iterator& last_issued_from_input,
 					unsigned num_warps_to_add,
 					OrderingType age_ordering,
@@ -439,6 +444,7 @@ class scheduler_unit { //this can be copied freely, so can be used in std contai
 				unsigned num_issued,
 				const std::vector< shd_warp_t* >::const_iterator& prioritized_iter );
 		inline int get_sid() const;
+		void sample_dps( unsigned n = 1 );
 	protected:
 		shd_warp_t& warp(int i);
 
@@ -454,6 +460,11 @@ class scheduler_unit { //this can be copied freely, so can be used in std contai
 		// Allow all schedulers to issue child warps during child consuming phase
 		std::vector< shd_warp_t* > m_all_warps;
 
+		// m_supervised_warps and m_all_warps in their last priority order, kept
+		// across cycles so order_by_priority only has to fix up what changed
+		std::vector< shd_warp_t* > m_supervised_warps_by_priority;
+		std::vector< shd_warp_t* > m_all_warps_by_priority;
+
 		// This is the iterator pointer to the last supervised warp you issued
 		std::vector< shd_warp_t* >::const_iterator m_last_supervised_issued;
 		shader_core_stats *m_stats;
@@ -548,6 +559,7 @@ class two_level_active_scheduler : public scheduler_unit {
 	}
 		virtual ~two_level_active_scheduler () {}
 		virtual void order_warps();
+		virtual bool idle_order_is_stateless() const { return false; }
 		void add_supervised_warp_id(int i) {
 			if ( m_next_cycle_prioritized_warps.size() < m_max_active_warps ) {
 				m_next_cycle_prioritized_warps.push_back( &warp(i) );
@@ -566,6 +578,7 @@ class two_level_active_scheduler : public scheduler_unit {
 
 	private:
 		std::deque< shd_warp_t* > m_pending_warps;
+		std::vector< shd_warp_t* > m_new_active; // reordering buffer for do_on_warp_issued
 		scheduler_prioritization_type m_inner_level_prioritization;
 		scheduler_prioritization_type m_outer_level_prioritization;
 		unsigned m_max_active_warps;
@@ -621,6 +634,8 @@ class opndcoll_rfu_t { // operand collector based register file unit
 				allocate_cu( p );
 			process_banks();
 		}
+		// step() with no instruction in flight only rotates the arbiter
+		void idle_step( unsigned n = 1 ) { m_arbiter.idle_cycle(n); }
 
 		void dump( FILE *fp ) const
 		{
@@ -692,7 +707,7 @@ class opndcoll_rfu_t { // operand collector based register file unit
 					else if( m_cu ) return m_cu->get_active_count();
 					else abort();
 				}
-				const active_mask_t & get_active_mask()
+				const active_mask_t & get_active_mask() const
 				{
 					if( m_warp ) return m_warp->get_active_mask();
 					else if( m_cu ) return m_cu->get_active_mask();
@@ -758,6 +773,40 @@ class opndcoll_rfu_t { // operand collector based register file unit
 				op_t m_op;
 		};
 
+		// FIFO of read requests to one bank; a ring that only grows while the
+		// number of outstanding requests reaches a new high
+		class bank_queue_t {
+			public:
+				bank_queue_t() { m_head=0; m_size=0; }
+				bool empty() const { return m_size == 0; }
+				unsigned size() const { return m_size; }
+				const op_t &at( unsigned i ) const { return m_ops[(m_head+i)%m_ops.size()]; }
+				op_t &front() { return m_ops[m_head]; }
+				const op_t &front() const { return m_ops[m_head]; }
+				void pop_front()
+				{
+					assert( m_size > 0 );
+					m_head = (m_head+1)%m_ops.size();
+					m_size--;
+				}
+				void push_back( const op_t &op )
+				{
+					if( m_size == m_ops.size() ) {
+						std::vector<op_t> ops( m_size ? 2*m_size : 8 );
+						for( unsigned i=0; i < m_size; i++ ) 
+							ops[i] = at(i);
+						m_ops.swap(ops);
+						m_head = 0;
+					}
+					m_ops[(m_head+m_size)%m_ops.size()] = op;
+					m_size++;
+				}
+			private:
+				std::vector<op_t> m_ops;
+				unsigned m_head;
+				unsigned m_size;
+		};
+
 		class arbiter_t {
 			public:
 				// constructors
@@ -766,23 +815,35 @@ class opndcoll_rfu_t { // operand collector based register file unit
 					m_queue=NULL;
 					m_allocated_bank=NULL;
 					m_allocator_rr_head=NULL;
+					m_grant_bank=NULL;
+					m_grant_diag=NULL;
+					m_granted=NULL;
+					m_last_cu=0;
+					m_legacy=false;
 					_inmatch=NULL;
 					_outmatch=NULL;
 					_request=NULL;
-					m_last_cu=0;
 				}
-				void init( unsigned num_cu, unsigned num_banks ) 
+				void init( unsigned num_cu, unsigned num_banks, bool legacy ) 
 				{ 
 					assert(num_cu > 0);
 					assert(num_banks > 0);
 					m_num_collectors = num_cu;
 					m_num_banks = num_banks;
-					_inmatch = new int[ m_num_banks ];
-					_outmatch = new int[ m_num_collectors ];
-					_request = new int*[ m_num_banks ];
-					for(unsigned i=0; i<m_num_banks;i++) 
-						_request[i] = new int[m_num_collectors];
-					m_queue = new std::list<op_t>[num_banks];
+					m_legacy = legacy;
+					if( m_legacy ) {
+						_inmatch = new int[ m_num_banks ];
+						_outmatch = new int[ m_num_collectors ];
+						_request = new int*[ m_num_banks ];
+						for(unsigned i=0; i<m_num_banks;i++) 
+							_request[i] = new int[m_num_collectors];
+					}
+					m_grant_bank = new int[ m_num_collectors ];
+					m_grant_diag = new unsigned[ m_num_collectors ];
+					for( unsigned n=0; n<num_cu; n++ ) 
+						m_grant_bank[n] = -1;
+					m_granted = new op_t[ m_num_banks ];
+					m_queue = new bank_queue_t[num_banks];
 					m_allocated_bank = new allocation_t[num_banks];
 					m_allocator_rr_head = new unsigned[num_cu];
 					for( unsigned n=0; n<num_cu;n++ ) 
@@ -798,9 +859,8 @@ class opndcoll_rfu_t { // operand collector based register file unit
 					fprintf(fp,"  requests:\n");
 					for( unsigned b=0; b<m_num_banks; b++ ) {
 						fprintf(fp,"    bank %u : ", b );
-						std::list<op_t>::const_iterator o = m_queue[b].begin();
-						for(; o != m_queue[b].end(); o++ ) {
-							o->dump(fp);
+						for( unsigned o=0; o < m_queue[b].size(); o++ ) {
+							m_queue[b].at(o).dump(fp);
 						}
 						fprintf(fp,"\n");
 					}
@@ -813,7 +873,11 @@ class opndcoll_rfu_t { // operand collector based register file unit
 				}
 
 				// modifiers
-				std::list<op_t> allocate_reads(); 
+				// grants one read to each of up to num_banks banks (in bank order),
+				// returns their number; the grants are read with granted()
+				unsigned allocate_reads(); 
+				unsigned allocate_reads_legacy(); 
+				const op_t &granted( unsigned i ) const { return m_granted[i]; }
 
 				void add_read_requests( collector_unit_t *cu ) 
 				{
@@ -845,17 +909,31 @@ class opndcoll_rfu_t { // operand collector based register file unit
 					for( unsigned b=0; b < m_num_banks; b++ ) 
 						m_allocated_bank[b].reset();
 				}
+				// priority rotation of n allocate_reads() without any request
+				void idle_cycle( unsigned n = 1 )
+				{
+					unsigned square = ( m_num_banks > m_num_collectors ) ? m_num_banks : m_num_collectors;
+					m_last_cu = ( m_last_cu + n % square ) % square;
+				}
 
 			private:
 				unsigned m_num_banks;
 				unsigned m_num_collectors;
 
 				allocation_t *m_allocated_bank; // bank # -> register that wins
-				std::list<op_t> *m_queue;
+				bank_queue_t *m_queue;
 
 				unsigned *m_allocator_rr_head; // cu # -> next bank to check for request (rr-arb)
 				unsigned  m_last_cu; // first cu to check while arb-ing banks (rr)
 
+				// wavefront allocator state: cu # -> requesting bank that wins it
+				// (-1 if none) and the diagonal of that request
+				int *m_grant_bank;
+				unsigned *m_grant_diag;
+				op_t *m_granted;
+
+				// -gpgpu_operand_collector_legacy_arbiter: full request matrix sweep
+				bool m_legacy;
 				int *_inmatch;
 				int *_outmatch;
 				int **_request;
@@ -882,7 +960,7 @@ class opndcoll_rfu_t { // operand collector based register file unit
 					m_free = true;
 					m_warp = NULL;
 					m_output_register = NULL;
-					m_src_op = new op_t[MAX_REG_OPERANDS*2];
+					m_collected = NULL;
 					m_not_ready.reset();
 					m_warp_id = -1;
 					m_num_banks = 0;
@@ -904,12 +982,16 @@ class opndcoll_rfu_t { // operand collector based register file unit
 						unsigned num_banks, 
 						unsigned log2_warp_size,
 						const core_config *config,
-						opndcoll_rfu_t *rfu ); 
+						opndcoll_rfu_t *rfu,
+						unsigned long long *collected,
+						unsigned set_idx ); 
 				bool allocate( register_set* pipeline_reg, register_set* output_reg );
 
 				void collect_operand( unsigned op )
 				{
 					m_not_ready.reset(op);
+					if( m_not_ready.none() ) 
+						*m_collected |= 1ULL << m_set_idx;
 				}
 				unsigned get_num_operands() const{
 					return m_warp->get_num_operands();
@@ -926,31 +1008,57 @@ class opndcoll_rfu_t { // operand collector based register file unit
 				unsigned m_warp_id;
 				warp_inst_t  *m_warp;
 				register_set* m_output_register; // pipeline register to issue to when ready
-				op_t *m_src_op;
+				op_t m_src_op[MAX_REG_OPERANDS*2];
 				std::bitset<MAX_REG_OPERANDS*2> m_not_ready;
 				unsigned m_num_banks;
 				unsigned m_bank_warp_shift;
 				opndcoll_rfu_t *m_rfu;
+				// allocated CUs of this collector set with all operands read
+				unsigned long long *m_collected;
+				unsigned m_set_idx; // bit of this CU in *m_collected
 
 		};
 
 		class dispatch_unit_t {
 			public:
-				dispatch_unit_t(std::vector<collector_unit_t>* cus) 
+				dispatch_unit_t(std::vector<collector_unit_t>* cus, const unsigned long long *collected) 
 				{ 
 					m_last_cu=0;
 					m_collector_units=cus;
+					m_collected=collected;
 					m_num_collectors = (*cus).size();
 					m_next_cu=0;
+					m_legacy=false;
 				}
+				void set_legacy( bool legacy ) { m_legacy = legacy; }
 
+				// round robin from the CU after m_last_cu, visiting only the CUs
+				// whose operands are all collected
 				collector_unit_t *find_ready()
 				{
-					for( unsigned n=0; n < m_num_collectors; n++ ) {
-						unsigned c=(m_last_cu+n+1)%m_num_collectors;
-						if( (*m_collector_units)[c].ready() ) {
-							m_last_cu=c;
-							return &((*m_collector_units)[c]);
+					if( m_legacy ) {
+						for( unsigned n=0; n < m_num_collectors; n++ ) {
+							unsigned c=(m_last_cu+n+1)%m_num_collectors;
+							if( (*m_collector_units)[c].ready() ) {
+								m_last_cu=c;
+								return &((*m_collector_units)[c]);
+							}
+						}
+						return NULL;
+					}
+					unsigned long long collected = *m_collected;
+					if( !collected ) 
+						return NULL;
+					unsigned start = (m_last_cu+1)%m_num_collectors;
+					unsigned long long above = collected & (~0ULL << start);
+					unsigned long long order[2] = { above, collected & ~above };
+					for( unsigned h=0; h < 2; h++ ) {
+						for( unsigned long long bits = order[h]; bits; bits &= bits-1 ) {
+							unsigned c = __builtin_ctzll(bits);
+							if( (*m_collector_units)[c].ready() ) {
+								m_last_cu=c;
+								return &((*m_collector_units)[c]);
+							}
 						}
 					}
 					return NULL;
@@ -959,8 +1067,10 @@ class opndcoll_rfu_t { // operand collector based register file unit
 			private:
 				unsigned m_num_collectors;
 				std::vector<collector_unit_t>* m_collector_units;
+				const unsigned long long *m_collected; // see collector_unit_t::m_collected
 				unsigned m_last_cu; // dispatch ready cu's rr
 				unsigned m_next_cu;  // for initialization
+				bool m_legacy; // scan every CU (-gpgpu_operand_collector_legacy_arbiter)
 		};
 
 		// opndcoll_rfu_t data members
@@ -983,6 +1093,8 @@ class opndcoll_rfu_t { // operand collector based register file unit
 		std::vector<input_port_t> m_in_ports;
 		typedef std::map<unsigned /* collector set */, std::vector<collector_unit_t> /*collector sets*/ > cu_sets_t;
 		cu_sets_t m_cus;
+		std::map<unsigned /* collector set */, unsigned long long> m_cu_set_collected;
+		std::vector< std::pair<unsigned,unsigned> > m_cu_set_pos; // m_cu index -> (collector set, index in set)
 		std::vector<dispatch_unit_t> m_dispatch_units;
 
 		//typedef std::map<warp_inst_t**/*port*/,dispatch_unit_t> port_to_du_t;
@@ -1078,6 +1190,8 @@ class simd_function_unit {
 		virtual unsigned clock_multiplier() const { return 1; }
 		virtual bool can_issue( const warp_inst_t &inst ) const { return m_dispatch_reg->empty() && !occupied.test(inst.latency); }
 		virtual bool stallable() const = 0;
+		// true if cycle() would not change any state
+		virtual bool idle() const { return m_dispatch_reg->empty() && occupied.none(); }
 		virtual void print( FILE *fp ) const
 		{
 			fprintf(fp,"%s dispatch= ", m_name.c_str() );
@@ -1125,6 +1239,13 @@ class pipelined_simd_unit : public simd_function_unit {
 		{
 			return simd_function_unit::can_issue(inst);
 		}
+		virtual bool idle() const
+		{
+			for( unsigned stage=0; stage < m_pipeline_depth; stage++ )
+				if( !m_pipeline_reg[stage]->empty() )
+					return false;
+			return simd_function_unit::idle();
+		}
 		virtual void print(FILE *fp) const
 		{
 			simd_function_unit::print(fp);
@@ -1219,6 +1340,8 @@ class ldst_unit: public pipelined_simd_unit {
 
 		virtual void active_lanes_in_pipeline();
 		virtual bool stallable() const { return true; }
+		virtual bool idle() const;
+		void idle_cycle( unsigned n = 1 );
 		bool response_buffer_full() const;
 		void print(FILE *fout) const;
 		void print_cache_stats( FILE *fp, unsigned& dl1_accesses, unsigned& dl1_misses );
@@ -1364,6 +1487,7 @@ struct shader_core_config : public core_config
 		m_valid = true;
 	}
 	void reg_options(class OptionParser * opp );
+	const kernel_occupancy_t &occupancy( const kernel_info_t &k ) const;
 	unsigned max_cta( const kernel_info_t &k ) const;
 	unsigned num_shader() const { return n_simt_clusters*n_simt_cores_per_cluster; }
 	unsigned sid_to_cluster( unsigned sid ) const { return sid / n_simt_cores_per_cluster; }
@@ -1413,6 +1537,7 @@ struct shader_core_config : public core_config
 	unsigned int gpgpu_operand_collector_num_out_ports_sfu;
 	unsigned int gpgpu_operand_collector_num_out_ports_mem;
 	unsigned int gpgpu_operand_collector_num_out_ports_gen;
+	bool gpgpu_operand_collector_legacy_arbiter;
 
 	int gpgpu_num_sp_units;
 	int gpgpu_num_sfu_units;
@@ -1435,6 +1560,7 @@ struct shader_core_config : public core_config
 	unsigned ldst_unit_response_queue_size;
 
 	int simt_core_sim_order; 
+	bool gpgpu_core_sleep;
 
 	unsigned mem2device(unsigned memid) const { return memid + n_simt_clusters; }
 
@@ -1707,6 +1833,9 @@ class shader_core_ctx : public core_t {
 		void cache_flush();
 		void accept_fetch_response( mem_fetch *mf );
 		void accept_ldst_unit_response( class mem_fetch * mf );
+		void wake() { m_sleeping = false; } // called by every event that can give a sleeping core work
+		bool sleeping() const { return m_sleeping; }
+		void sleep_cycle( unsigned n = 1 ); // n cycle() of a sleeping core
 		void broadcast_barrier_reduction(unsigned cta_id, unsigned bar_id,warp_set_t warps);
 
 		void set_kernel( kernel_info_t *k ) 
@@ -1923,6 +2052,9 @@ class shader_core_ctx : public core_t {
 
 		void writeback();
 
+		// sleep/wake gating of an idle core (-gpgpu_core_sleep)
+		bool can_sleep();
+
 		// used in display_pipeline():
 		void dump_warp_state( FILE *fout ) const;
 		void print_stage(unsigned int stage, FILE *fout) const;
@@ -1944,6 +2076,9 @@ class shader_core_ctx : public core_t {
 		mem_fetch_interface *m_icnt;
 		shader_core_mem_fetch_allocator *m_mem_fetch_allocator;
 
+		// set while the core has no work; cleared by CTA issue or a memory response
+		bool m_sleeping;
+
 		// fetch
 		read_only_cache *m_L1I; // instruction cache
 		int  m_last_warp_fetched;
@@ -2032,6 +2167,10 @@ class simt_core_cluster {
 
 		void core_cycle();
 		void icnt_cycle();
+		// true if icnt_cycle() and (when core_cycled) core_cycle() only
+		// update idle statistics; idle_core_cycle(n) stands for n core_cycle()
+		bool idle( bool core_cycled ) const;
+		void idle_core_cycle( unsigned n );
 
 		void reinit();
 		unsigned issue_block2core();
@@ -108,6 +108,20 @@ void spill_log_to_file (FILE *fout, int final, unsigned long long  current_cycle
    next_spill_cycle = current_cycle + spill_interval; // WF: stateful testing, maybe bad
 }
 
+// number of cycles after current_cycle for which try_snap_shot() and
+// spill_log_to_file() will do nothing
+unsigned long long stat_log_idle_cycles (unsigned long long  current_cycle)
+{
+   unsigned long long idle = (unsigned long long)-1;
+   if (min_snap_shot_interval != 0 && next_snap_shot_cycle > current_cycle) 
+      idle = next_snap_shot_cycle - current_cycle - 1;
+   if (spill_interval != 0) {
+      unsigned long long spill_idle = (next_spill_cycle > current_cycle)? next_spill_cycle - current_cycle : 0;
+      if (spill_idle < idle) idle = spill_idle;
+   }
+   return idle;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 unsigned translate_pc_to_ptxlineno(unsigned pc);
@@ -89,6 +89,7 @@ void *gpgpu_sim_thread_sequential(void*)
 }
 
 pthread_mutex_t g_sim_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t g_sim_idle_cv = PTHREAD_COND_INITIALIZER; // signalled when g_sim_active drops
 bool g_sim_active = false;
 bool g_sim_done = true;
 
@@ -100,16 +101,7 @@ void *gpgpu_sim_thread_concurrent(void*)
 	    printf("GPGPU-Sim: *** simulation thread starting and spinning waiting for work ***\n");
 	    fflush(stdout);
 	}
-        unsigned int wait_amount = 100; 
-        unsigned int wait_cap = 100000; // 100ms 
-	while( g_stream_manager->empty() && !g_sim_done ){
-            // sleep to prevent CPU hog by empty spin
-            // sleep time increased exponentially ensure fast response when needed 
-            usleep(wait_amount); 
-            wait_amount *= 2; 
-            if (wait_amount > wait_cap) 
-               wait_amount = wait_cap; 
-	}
+	g_stream_manager->wait_for_work(&g_sim_done);
 	if(g_debug_execution >= 3) {
 	    printf("GPGPU-Sim: ** START simulation thread (detected work) **\n");
 	    g_stream_manager->print(stdout);
@@ -125,6 +117,9 @@ void *gpgpu_sim_thread_concurrent(void*)
 	    // check if a kernel has completed
 	    // launch operation on device if one is pending and can be run
 
+	    if( g_the_gpu->get_config().idle_fast_forward() )
+		g_stream_manager->fast_forward_idle(&sim_cycles);
+
 	    // Need to break this loop when a kernel completes. This was a
 	    // source of non-deterministic behaviour in GPGPU-Sim (bug 147).
 	    // If another stream operation is available, g_the_gpu remains active,
@@ -175,6 +170,7 @@ void *gpgpu_sim_thread_concurrent(void*)
 	}
 	pthread_mutex_lock(&g_sim_lock);
 	g_sim_active = false;
+	pthread_cond_broadcast(&g_sim_idle_cv);
 	pthread_mutex_unlock(&g_sim_lock);
     } while( !g_sim_done );
     if(g_debug_execution >= 3) {
@@ -191,12 +187,10 @@ void synchronize()
     g_stream_manager->print(stdout);
     fflush(stdout);
     //    sem_wait(&g_sim_signal_finish);
-    bool done = false;
-    do {
-	pthread_mutex_lock(&g_sim_lock);
-	done = g_stream_manager->empty() && !g_sim_active;
-	pthread_mutex_unlock(&g_sim_lock);
-    } while (!done);
+    pthread_mutex_lock(&g_sim_lock);
+    while( !(g_stream_manager->empty() && !g_sim_active) ) 
+	pthread_cond_wait(&g_sim_idle_cv,&g_sim_lock);
+    pthread_mutex_unlock(&g_sim_lock);
     printf("GPGPU-Sim: detected inactive GPU simulation thread\n");
     fflush(stdout);
     //    sem_post(&g_sim_signal_start);
@@ -205,6 +199,7 @@ void synchronize()
 void exit_simulation()
 {
     g_sim_done=true;
+    g_stream_manager->notify_event(); // wake the simulation thread if it is waiting for work
     printf("GPGPU-Sim: exit_simulation called\n");
     fflush(stdout);
     sem_wait(&g_sim_signal_exit);
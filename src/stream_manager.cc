@@ -29,6 +29,9 @@
 #include "gpgpusim_entrypoint.h"
 #include "cuda-sim/cuda-sim.h"
 #include "gpgpu-sim/gpu-sim.h"
+#include "gpgpu-sim/checkpoint.h"
+#include "gpgpu-sim/sampler.h"
+#include "gpgpu-sim/memoizer.h"
 
 //Po-Han DCC
 #include "cuda-sim/cuda_device_runtime.h"
@@ -39,6 +42,8 @@ CUstream_st::CUstream_st()
 {
     m_pending = false;
     m_uid = sm_next_stream_uid++;
+    m_manager = NULL;
+    m_order = 0;
     pthread_mutexattr_init(&m_attr);
     pthread_mutexattr_settype(&m_attr, PTHREAD_MUTEX_RECURSIVE);
     pthread_mutex_init(&m_lock, &m_attr);
@@ -65,6 +70,10 @@ bool CUstream_st::busy()
 void CUstream_st::synchronize() 
 {
     // called by host thread
+    if( m_manager ) {
+        m_manager->wait_stream_empty(this);
+        return;
+    }
     bool done=false;
     do{
         pthread_mutex_lock(&m_lock);
@@ -77,8 +86,16 @@ void CUstream_st::push( const stream_operation &op )
 {
     // called by host thread
     pthread_mutex_lock(&m_lock);
+    bool was_empty = m_operations.empty(); // an empty stream is never pending
     m_operations.push_back( op );
+    if( was_empty && m_manager ) 
+        m_manager->count_nonempty(this, 1);
     pthread_mutex_unlock(&m_lock);
+    if( m_manager ) {
+        if( was_empty ) 
+            m_manager->stream_ready(this);
+        m_manager->notify_event();
+    }
 }
 
 void CUstream_st::record_next_done()
@@ -88,10 +105,27 @@ void CUstream_st::record_next_done()
     assert(m_pending);
     m_operations.pop_front();
     m_pending=false;
+    bool empty = m_operations.empty();
+    if( empty && m_manager ) 
+        m_manager->count_nonempty(this, -1);
     pthread_mutex_unlock(&m_lock);
+    if( m_manager ) {
+        if( !empty ) 
+            m_manager->stream_ready(this);
+        m_manager->notify_event();
+    }
 }
 
 
+stream_operation CUstream_st::peek()
+{
+    // called by gpu thread, unlike next() the operation is not started
+    pthread_mutex_lock(&m_lock);
+    stream_operation result = m_operations.front();
+    pthread_mutex_unlock(&m_lock);
+    return result;
+}
+
 stream_operation CUstream_st::next()
 {
     // called by gpu thread
@@ -108,7 +142,8 @@ void CUstream_st::cancel_front()
     assert(m_pending);
     m_pending = false;
     pthread_mutex_unlock(&m_lock);
-
+    if( m_manager ) 
+        m_manager->stream_ready(this);
 }
 
 void CUstream_st::print(FILE *fp)
@@ -167,7 +202,14 @@ bool stream_operation::do_operation( gpgpu_sim *gpu )
         m_stream->record_next_done();
         break;
     case stream_kernel_launch:
-        if( m_sim_mode ) { //Functional Sim
+        if( !m_sim_mode && gpu->get_sampler() && gpu->get_sampler()->fast_forward(m_kernel) ) {
+            // fast-forwarded host kernels start once the detailed sample has drained
+            if( m_kernel->get_parent() == NULL && gpu->active() )
+                return false;
+            printf("kernel %d: \'%s\' fast-forwarded by sampled simulation\n", m_kernel->get_uid(), m_kernel->name().c_str() );
+            gpu->functional_launch( m_kernel );
+        }
+        else if( m_sim_mode ) { //Functional Sim
             printf("kernel %d: \'%s\' transfer to GPU hardware scheduler\n", m_kernel->get_uid(), m_kernel->name().c_str() );
                 m_kernel->print_parent_info();
         	gpu->set_cache_config(m_kernel->name());
@@ -229,6 +271,61 @@ stream_manager::stream_manager( gpgpu_sim *gpu, bool cuda_launch_blocking )
     m_service_stream_zero = false;
     m_cuda_launch_blocking = cuda_launch_blocking;
     pthread_mutex_init(&stm_m_lock,NULL);
+    pthread_mutex_init(&m_ready_lock,NULL);
+    pthread_mutex_init(&m_event_lock,NULL);
+    pthread_cond_init(&m_event_cv,NULL);
+    m_next_stream_order = 0;
+    m_n_nonempty = 0;
+    m_stream_zero.m_manager = this;
+}
+
+void stream_manager::stream_ready( CUstream_st *stream )
+{
+    // stream zero is checked first by front() on its own
+    if( stream == &m_stream_zero ) 
+        return;
+    pthread_mutex_lock(&m_ready_lock);
+    m_ready[stream->m_order] = stream;
+    pthread_mutex_unlock(&m_ready_lock);
+}
+
+void stream_manager::count_nonempty( CUstream_st *stream, int delta )
+{
+    if( stream != &m_stream_zero ) 
+        __sync_fetch_and_add(&m_n_nonempty, delta);
+}
+
+void stream_manager::notify_event()
+{
+    pthread_mutex_lock(&m_event_lock);
+    pthread_cond_broadcast(&m_event_cv);
+    pthread_mutex_unlock(&m_event_lock);
+}
+
+void stream_manager::wait_for_work( const bool *done )
+{
+    // called by the simulation thread while it has nothing to simulate
+    pthread_mutex_lock(&m_event_lock);
+    while( empty() && !*done ) 
+        pthread_cond_wait(&m_event_cv,&m_event_lock);
+    pthread_mutex_unlock(&m_event_lock);
+}
+
+void stream_manager::wait_until_empty( bool concurrent_only )
+{
+    // must not be called with stm_m_lock held: push() notifies under it
+    pthread_mutex_lock(&m_event_lock);
+    while( concurrent_only ? !concurrent_streams_empty() : !empty() ) 
+        pthread_cond_wait(&m_event_cv,&m_event_lock);
+    pthread_mutex_unlock(&m_event_lock);
+}
+
+void stream_manager::wait_stream_empty( CUstream_st *stream )
+{
+    pthread_mutex_lock(&m_event_lock);
+    while( !stream->empty() ) 
+        pthread_cond_wait(&m_event_cv,&m_event_lock);
+    pthread_mutex_unlock(&m_event_lock);
 }
 
 bool stream_manager::operation( bool * sim)
@@ -237,7 +334,16 @@ bool stream_manager::operation( bool * sim)
     pthread_mutex_lock(&stm_m_lock);
 //    if(check)m_gpu->print_stats();
     stream_operation op =front();
-    if(!op.do_operation( m_gpu )) //not ready to execute
+    sim_checkpoint *ckpt = m_gpu->get_checkpoint();
+    kernel_memoizer *memo = m_gpu->get_memoizer();
+    bool host_kernel = op.is_kernel() && op.get_kernel()->get_parent() == NULL;
+    if( ckpt && host_kernel && ckpt->host_kernel_boundary(op.get_kernel()) ) {
+        // already simulated before the restored checkpoint
+        printf("kernel %d: \'%s\' skipped, restoring checkpoint\n", op.get_kernel()->get_uid(), op.get_kernel()->name().c_str() );
+        retire_without_launch(op);
+    } else if( memo && host_kernel && !op.sim_mode() && memo->host_kernel_ready(op.get_kernel()) ) {
+        retire_without_launch(op);
+    } else if(!op.do_operation( m_gpu )) //not ready to execute
     {
         //cancel operation
         if( op.is_kernel() ) {
@@ -246,6 +352,8 @@ bool stream_manager::operation( bool * sim)
         }
         op.get_stream()->cancel_front();
 
+    } else if( memo && !op.is_noop() ) {
+        memo->operation_done( op.is_kernel() ? op.get_kernel() : NULL );
     }
     pthread_mutex_unlock(&stm_m_lock);
     //pthread_mutex_lock(&m_lock);
@@ -253,6 +361,73 @@ bool stream_manager::operation( bool * sim)
     return check;
 }
 
+stream_operation stream_manager::peek_front()
+{
+    // the operation front() would start next, left in its stream
+    stream_operation result;
+    if( !m_stream_zero.empty() && !m_stream_zero.busy() ) 
+        return m_stream_zero.peek();
+    pthread_mutex_lock(&m_ready_lock);
+    std::map<unsigned,CUstream_st *>::iterator s;
+    for( s = m_ready.begin(); s != m_ready.end(); s++ ) {
+        CUstream_st *stream = s->second;
+        if( !stream->empty() && !stream->busy() ) {
+            result = stream->peek();
+            break;
+        }
+    }
+    pthread_mutex_unlock(&m_ready_lock);
+    return result;
+}
+
+void stream_manager::fast_forward_idle( bool *sim )
+{
+    // called by gpu simulation thread before operation(): skips the loop
+    // iterations in which operation() can at most count down the launch
+    // latency of the next kernel and cycle() only updates idle statistics
+    if( m_gpu->get_sampler() || m_gpu->get_checkpoint() || m_gpu->get_memoizer() || g_debug_execution >= 3 ) 
+        return;
+    if( m_gpu->has_finished_kernel() || m_gpu->is_functional_sim() ) 
+        return;
+    pthread_mutex_lock(&stm_m_lock);
+    stream_operation op = peek_front();
+    kernel_info_t *kernel = NULL;
+    unsigned long long iterations = (unsigned long long)-1;
+    if( !op.is_noop() ) {
+        if( !op.is_kernel() || op.sim_mode() ) {
+            pthread_mutex_unlock(&stm_m_lock);
+            return;
+        }
+        kernel = op.get_kernel();
+        if( kernel->m_launch_latency ) 
+            iterations = kernel->m_launch_latency;
+        else if( m_gpu->can_start_kernel() ) {
+            pthread_mutex_unlock(&stm_m_lock);
+            return;
+        }
+    }
+    if( !m_gpu->active() ) {
+        // no cycle is simulated while the GPU is idle
+        if( kernel ) 
+            kernel->m_launch_latency = 0;
+    } else {
+        unsigned long long n = m_gpu->fast_forward_idle(iterations);
+        if( n ) 
+            *sim = true;
+        if( kernel ) 
+            kernel->m_launch_latency -= n;
+    }
+    pthread_mutex_unlock(&stm_m_lock);
+}
+
+void stream_manager::retire_without_launch( stream_operation &op )
+{
+    kernel_info_t *kernel = op.get_kernel();
+    m_grid_id_to_stream.erase(kernel->get_uid());
+    op.get_stream()->record_next_done();
+    delete kernel;
+}
+
 bool stream_manager::check_finished_kernel()
 {
     unsigned grid_uid = m_gpu->finished_kernel();
@@ -283,6 +458,10 @@ bool stream_manager::register_finished_kernel(unsigned grid_uid)
             kernel_stat<< ", start " << kernel->start_cycle <<
                 ", end " << kernel->end_cycle << ", retire " << gpu_sim_cycle + gpu_tot_sim_cycle << "\n";
 	    } else {
+		    if( m_gpu->get_sampler() )
+			    m_gpu->get_sampler()->host_kernel_finished(kernel);
+		    if( m_gpu->get_memoizer() )
+			    m_gpu->get_memoizer()->host_kernel_finished(kernel);
 		    extern unsigned long long max_concurrent_device_kernel, concurrent_device_kernel;
 		    if(max_concurrent_device_kernel < concurrent_device_kernel) max_concurrent_device_kernel = concurrent_device_kernel;
 		    concurrent_device_kernel = 0;
@@ -330,11 +509,17 @@ stream_operation stream_manager::front()
     
     if(!m_service_stream_zero)
     {
-        std::list<struct CUstream_st*>::iterator s, s_end;
-	s_end = m_streams.end();
-//        if(m_streams.size() != 0){
-        for( s=m_streams.begin(); s != s_end/*m_streams.end()*/; s++) {
-            CUstream_st *stream = *s;
+        // first ready stream in m_streams order; entries made stale by a
+        // concurrent state change are dropped, the change re-inserts them
+        while( true ) {
+            pthread_mutex_lock(&m_ready_lock);
+            if( m_ready.empty() ) {
+                pthread_mutex_unlock(&m_ready_lock);
+                break;
+            }
+            CUstream_st *stream = m_ready.begin()->second;
+            m_ready.erase(m_ready.begin());
+            pthread_mutex_unlock(&m_ready_lock);
             if( !stream->empty()/*busy()*/ && !stream->busy()/*empty()*/ ) {
                 result = stream->next();
                 if( result.is_kernel() ) {
@@ -344,7 +529,6 @@ stream_operation stream_manager::front()
                 break;
             }
         }
-//        }
     }
     return result;
 }
@@ -353,25 +537,27 @@ void stream_manager::add_stream( struct CUstream_st *stream )
 {
     // called by host thread
     pthread_mutex_lock(&stm_m_lock);
-    m_streams.push_back(stream);
+    stream->m_manager = this;
+    stream->m_order = m_next_stream_order++;
+    stream->m_pos = m_streams.insert(m_streams.end(), stream);
     pthread_mutex_unlock(&stm_m_lock);
+    if( !stream->empty() ) {
+        count_nonempty(stream, 1);
+        stream_ready(stream);
+    }
 }
 
 void stream_manager::destroy_stream( CUstream_st *stream )
 {
     // called by host thread
+    wait_stream_empty(stream);
     pthread_mutex_lock(&stm_m_lock);
     while( !stream->empty() )
         ; 
-    std::list<CUstream_st *>::iterator s;
-//        if(m_streams.size() != 0){
-    for( s=m_streams.begin(); s != m_streams.end(); s++ ) {
-        if( *s == stream ) {
-            m_streams.erase(s);
-            break;
-        }
-    }
-//        }
+    m_streams.erase(stream->m_pos);
+    pthread_mutex_lock(&m_ready_lock);
+    m_ready.erase(stream->m_order);
+    pthread_mutex_unlock(&m_ready_lock);
     delete stream; 
     pthread_mutex_unlock(&stm_m_lock);
 }
@@ -385,21 +571,8 @@ bool stream_manager::has_stream( CUstream_st *stream ){
 
 bool stream_manager::concurrent_streams_empty()
 {
-    bool result = true;
     // called by gpu simulation thread
-    std::list<struct CUstream_st *>::iterator s, s_end;
-    if (!m_streams.empty()){
-	unsigned idx = 0;
-	s_end = m_streams.end();
-	for( s=m_streams.begin(); s!=s_end/*m_streams.end()*/;s++, idx++ ) {
-	    struct CUstream_st *stream = *s;
-	    if( !stream->empty() ) {
-		//            stream->print(stdout);
-		result = false;
-	    }
-	}
-    }
-    return result;
+    return m_n_nonempty == 0;
 }
 
 bool stream_manager::empty_protected()
@@ -460,12 +633,8 @@ void stream_manager::push( stream_operation op )
     struct CUstream_st *stream = op.get_stream();
 
     // block if stream 0 (or concurrency disabled) and pending concurrent operations exist
-    bool block= !stream || m_cuda_launch_blocking;
-    while(block) {
-        pthread_mutex_lock(&stm_m_lock);
-        block = !concurrent_streams_empty();
-        pthread_mutex_unlock(&stm_m_lock);
-    };
+    if( !stream || m_cuda_launch_blocking ) 
+        wait_until_empty(true);
 
     pthread_mutex_lock(&stm_m_lock);
     if( stream && !m_cuda_launch_blocking ) {
@@ -477,18 +646,8 @@ void stream_manager::push( stream_operation op )
     if(g_debug_execution >= 3)
        print_impl(stdout);
     pthread_mutex_unlock(&stm_m_lock);
-    if( m_cuda_launch_blocking || stream == NULL ) {
-        unsigned int wait_amount = 100; 
-        unsigned int wait_cap = 100000; // 100ms 
-        while( !empty_protected() ) {
-            // sleep to prevent CPU hog by empty spin
-            // sleep time increased exponentially ensure fast response when needed 
-            usleep(wait_amount); 
-            wait_amount *= 2; 
-            if (wait_amount > wait_cap) 
-               wait_amount = wait_cap; 
-        }
-    }
+    if( m_cuda_launch_blocking || stream == NULL ) 
+        wait_until_empty(false);
 }
 
 //Jin: aggregated blocks support
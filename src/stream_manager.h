@@ -30,6 +30,7 @@
 
 #include "abstract_hardware_model.h"
 #include <list>
+#include <map>
 #include <pthread.h>
 #include <time.h>
 
@@ -151,6 +152,7 @@ public:
                m_type == stream_memcpy_host_to_device;
     }
     bool is_noop() const { return m_type == stream_no_op; }
+    bool sim_mode() const { return m_sim_mode; }
     bool is_done() const { return m_done; }
     kernel_info_t *get_kernel() { return m_kernel; }
     bool do_operation( gpgpu_sim *gpu );
@@ -212,6 +214,8 @@ private:
    static int m_next_event_uid;
 };
 
+class stream_manager;
+
 struct CUstream_st {
 public:
     CUstream_st(); 
@@ -227,6 +231,7 @@ public:
     void push( const stream_operation &op );
     void record_next_done();
     stream_operation next();
+    stream_operation peek();
     void cancel_front(); //front operation fails, cancle the pending status
     stream_operation &front() { return m_operations.front(); }
     void print( FILE *fp );
@@ -244,6 +249,12 @@ private:
 
     pthread_mutex_t m_lock; // ensure only one host or gpu manipulates stream operation at one time
     pthread_mutexattr_t m_attr;
+
+    // bookkeeping of the stream manager this stream is registered with
+    friend class stream_manager;
+    stream_manager *m_manager;
+    unsigned m_order; // position among the concurrent streams
+    std::list<CUstream_st *>::iterator m_pos;
 };
 
 class stream_manager {
@@ -260,13 +271,27 @@ public:
     void print( FILE *fp);
     void push( stream_operation op );
     bool operation(bool * sim);
+    void fast_forward_idle(bool * sim);
     //Jin: support aggregated blocks
     kernel_info_t * find_grid(function_info * entry, kernel_info_t *parent_grid, unsigned parent_block_idx);
     unsigned stream_count();
     bool has_stream( CUstream_st *stream );
     unsigned gpu_can_start_kernel();
+
+    // blocking waits, woken by the stream state changes below
+    void wait_for_work( const bool *done );
+    void wait_stream_empty( CUstream_st *stream );
+    void notify_event();
+
+    // called by a stream after its state changed (outside of its lock)
+    void stream_ready( CUstream_st *stream );
+    // called by a stream under its lock when it becomes (non-)empty
+    void count_nonempty( CUstream_st *stream, int delta );
 private:
     void print_impl( FILE *fp);
+    stream_operation peek_front();
+    void retire_without_launch( stream_operation &op );
+    void wait_until_empty( bool concurrent_only );
 
     bool m_cuda_launch_blocking;
     gpgpu_sim *m_gpu;
@@ -275,6 +300,16 @@ private:
     CUstream_st m_stream_zero;
     bool m_service_stream_zero;
     pthread_mutex_t stm_m_lock;
+
+    // concurrent streams whose front operation can be started, in m_streams
+    // order, so front() does not have to scan every stream each cycle
+    std::map<unsigned,CUstream_st *> m_ready;
+    pthread_mutex_t m_ready_lock;
+    unsigned m_next_stream_order;
+    volatile int m_n_nonempty; // concurrent streams with pending operations
+
+    pthread_mutex_t m_event_lock;
+    pthread_cond_t m_event_cv;
 };
 
 #endif